@@ -1,519 +0,0 @@
-		"MOVNTDQA 0x0000(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0010(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0020(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0030(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0000(%%rsi);"
-		"MOVDQA %%xmm1, 0x0010(%%rsi);"
-		"MOVDQA %%xmm2, 0x0020(%%rsi);"
-		"MOVDQA %%xmm3, 0x0030(%%rsi);"
-		"MFENCE;"
-		"MOVNTDQA 0x0040(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0050(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0060(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0070(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0040(%%rsi);"
-		"MOVDQA %%xmm1, 0x0050(%%rsi);"
-		"MOVDQA %%xmm2, 0x0060(%%rsi);"
-		"MOVDQA %%xmm3, 0x0070(%%rsi);"
-		"MFENCE;"
-		"MOVNTDQA 0x0080(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0090(%%rax), %%xmm1;"
-		"MOVNTDQA 0x00a0(%%rax), %%xmm2;"
-		"MOVNTDQA 0x00b0(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0080(%%rsi);"
-		"MOVDQA %%xmm1, 0x0090(%%rsi);"
-		"MOVDQA %%xmm2, 0x00a0(%%rsi);"
-		"MOVDQA %%xmm3, 0x00b0(%%rsi);"
-		"MFENCE;"
-		"MOVNTDQA 0x00c0(%%rax), %%xmm0;"
-		"MOVNTDQA 0x00d0(%%rax), %%xmm1;"
-		"MOVNTDQA 0x00e0(%%rax), %%xmm2;"
-		"MOVNTDQA 0x00f0(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x00c0(%%rsi);"
-		"MOVDQA %%xmm1, 0x00d0(%%rsi);"
-		"MOVDQA %%xmm2, 0x00e0(%%rsi);"
-		"MOVDQA %%xmm3, 0x00f0(%%rsi);"
-		"MFENCE;"
-		"MOVNTDQA 0x0100(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0110(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0120(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0130(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0100(%%rsi);"
-		"MOVDQA %%xmm1, 0x0110(%%rsi);"
-		"MOVDQA %%xmm2, 0x0120(%%rsi);"
-		"MOVDQA %%xmm3, 0x0130(%%rsi);"
-		"MFENCE;"
-		"MOVNTDQA 0x0140(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0150(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0160(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0170(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0140(%%rsi);"
-		"MOVDQA %%xmm1, 0x0150(%%rsi);"
-		"MOVDQA %%xmm2, 0x0160(%%rsi);"
-		"MOVDQA %%xmm3, 0x0170(%%rsi);"
-		"MFENCE;"
-		"MOVNTDQA 0x0180(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0190(%%rax), %%xmm1;"
-		"MOVNTDQA 0x01a0(%%rax), %%xmm2;"
-		"MOVNTDQA 0x01b0(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0180(%%rsi);"
-		"MOVDQA %%xmm1, 0x0190(%%rsi);"
-		"MOVDQA %%xmm2, 0x01a0(%%rsi);"
-		"MOVDQA %%xmm3, 0x01b0(%%rsi);"
-		"MOVNTDQA 0x01c0(%%rax), %%xmm0;"
-		"MOVNTDQA 0x01d0(%%rax), %%xmm1;"
-		"MOVNTDQA 0x01e0(%%rax), %%xmm2;"
-		"MOVNTDQA 0x01f0(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x01c0(%%rsi);"
-		"MOVDQA %%xmm1, 0x01d0(%%rsi);"
-		"MOVDQA %%xmm2, 0x01e0(%%rsi);"
-		"MOVDQA %%xmm3, 0x01f0(%%rsi);"
-		"MOVNTDQA 0x0200(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0210(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0220(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0230(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0200(%%rsi);"
-		"MOVDQA %%xmm1, 0x0210(%%rsi);"
-		"MOVDQA %%xmm2, 0x0220(%%rsi);"
-		"MOVDQA %%xmm3, 0x0230(%%rsi);"
-		"MOVNTDQA 0x0240(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0250(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0260(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0270(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0240(%%rsi);"
-		"MOVDQA %%xmm1, 0x0250(%%rsi);"
-		"MOVDQA %%xmm2, 0x0260(%%rsi);"
-		"MOVDQA %%xmm3, 0x0270(%%rsi);"
-		"MOVNTDQA 0x0280(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0290(%%rax), %%xmm1;"
-		"MOVNTDQA 0x02a0(%%rax), %%xmm2;"
-		"MOVNTDQA 0x02b0(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0280(%%rsi);"
-		"MOVDQA %%xmm1, 0x0290(%%rsi);"
-		"MOVDQA %%xmm2, 0x02a0(%%rsi);"
-		"MOVDQA %%xmm3, 0x02b0(%%rsi);"
-		"MOVNTDQA 0x02c0(%%rax), %%xmm0;"
-		"MOVNTDQA 0x02d0(%%rax), %%xmm1;"
-		"MOVNTDQA 0x02e0(%%rax), %%xmm2;"
-		"MOVNTDQA 0x02f0(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x02c0(%%rsi);"
-		"MOVDQA %%xmm1, 0x02d0(%%rsi);"
-		"MOVDQA %%xmm2, 0x02e0(%%rsi);"
-		"MOVDQA %%xmm3, 0x02f0(%%rsi);"
-		"MOVNTDQA 0x0300(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0310(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0320(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0330(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0300(%%rsi);"
-		"MOVDQA %%xmm1, 0x0310(%%rsi);"
-		"MOVDQA %%xmm2, 0x0320(%%rsi);"
-		"MOVDQA %%xmm3, 0x0330(%%rsi);"
-		"MOVNTDQA 0x0340(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0350(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0360(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0370(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0340(%%rsi);"
-		"MOVDQA %%xmm1, 0x0350(%%rsi);"
-		"MOVDQA %%xmm2, 0x0360(%%rsi);"
-		"MOVDQA %%xmm3, 0x0370(%%rsi);"
-		"MOVNTDQA 0x0380(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0390(%%rax), %%xmm1;"
-		"MOVNTDQA 0x03a0(%%rax), %%xmm2;"
-		"MOVNTDQA 0x03b0(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0380(%%rsi);"
-		"MOVDQA %%xmm1, 0x0390(%%rsi);"
-		"MOVDQA %%xmm2, 0x03a0(%%rsi);"
-		"MOVDQA %%xmm3, 0x03b0(%%rsi);"
-		"MOVNTDQA 0x03c0(%%rax), %%xmm0;"
-		"MOVNTDQA 0x03d0(%%rax), %%xmm1;"
-		"MOVNTDQA 0x03e0(%%rax), %%xmm2;"
-		"MOVNTDQA 0x03f0(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x03c0(%%rsi);"
-		"MOVDQA %%xmm1, 0x03d0(%%rsi);"
-		"MOVDQA %%xmm2, 0x03e0(%%rsi);"
-		"MOVDQA %%xmm3, 0x03f0(%%rsi);"
-		"MOVNTDQA 0x0400(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0410(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0420(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0430(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0400(%%rsi);"
-		"MOVDQA %%xmm1, 0x0410(%%rsi);"
-		"MOVDQA %%xmm2, 0x0420(%%rsi);"
-		"MOVDQA %%xmm3, 0x0430(%%rsi);"
-		"MOVNTDQA 0x0440(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0450(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0460(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0470(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0440(%%rsi);"
-		"MOVDQA %%xmm1, 0x0450(%%rsi);"
-		"MOVDQA %%xmm2, 0x0460(%%rsi);"
-		"MOVDQA %%xmm3, 0x0470(%%rsi);"
-		"MOVNTDQA 0x0480(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0490(%%rax), %%xmm1;"
-		"MOVNTDQA 0x04a0(%%rax), %%xmm2;"
-		"MOVNTDQA 0x04b0(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0480(%%rsi);"
-		"MOVDQA %%xmm1, 0x0490(%%rsi);"
-		"MOVDQA %%xmm2, 0x04a0(%%rsi);"
-		"MOVDQA %%xmm3, 0x04b0(%%rsi);"
-		"MOVNTDQA 0x04c0(%%rax), %%xmm0;"
-		"MOVNTDQA 0x04d0(%%rax), %%xmm1;"
-		"MOVNTDQA 0x04e0(%%rax), %%xmm2;"
-		"MOVNTDQA 0x04f0(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x04c0(%%rsi);"
-		"MOVDQA %%xmm1, 0x04d0(%%rsi);"
-		"MOVDQA %%xmm2, 0x04e0(%%rsi);"
-		"MOVDQA %%xmm3, 0x04f0(%%rsi);"
-		"MOVNTDQA 0x0500(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0510(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0520(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0530(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0500(%%rsi);"
-		"MOVDQA %%xmm1, 0x0510(%%rsi);"
-		"MOVDQA %%xmm2, 0x0520(%%rsi);"
-		"MOVDQA %%xmm3, 0x0530(%%rsi);"
-		"MOVNTDQA 0x0540(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0550(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0560(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0570(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0540(%%rsi);"
-		"MOVDQA %%xmm1, 0x0550(%%rsi);"
-		"MOVDQA %%xmm2, 0x0560(%%rsi);"
-		"MOVDQA %%xmm3, 0x0570(%%rsi);"
-		"MOVNTDQA 0x0580(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0590(%%rax), %%xmm1;"
-		"MOVNTDQA 0x05a0(%%rax), %%xmm2;"
-		"MOVNTDQA 0x05b0(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0580(%%rsi);"
-		"MOVDQA %%xmm1, 0x0590(%%rsi);"
-		"MOVDQA %%xmm2, 0x05a0(%%rsi);"
-		"MOVDQA %%xmm3, 0x05b0(%%rsi);"
-		"MOVNTDQA 0x05c0(%%rax), %%xmm0;"
-		"MOVNTDQA 0x05d0(%%rax), %%xmm1;"
-		"MOVNTDQA 0x05e0(%%rax), %%xmm2;"
-		"MOVNTDQA 0x05f0(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x05c0(%%rsi);"
-		"MOVDQA %%xmm1, 0x05d0(%%rsi);"
-		"MOVDQA %%xmm2, 0x05e0(%%rsi);"
-		"MOVDQA %%xmm3, 0x05f0(%%rsi);"
-		"MOVNTDQA 0x0600(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0610(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0620(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0630(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0600(%%rsi);"
-		"MOVDQA %%xmm1, 0x0610(%%rsi);"
-		"MOVDQA %%xmm2, 0x0620(%%rsi);"
-		"MOVDQA %%xmm3, 0x0630(%%rsi);"
-		"MOVNTDQA 0x0640(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0650(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0660(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0670(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0640(%%rsi);"
-		"MOVDQA %%xmm1, 0x0650(%%rsi);"
-		"MOVDQA %%xmm2, 0x0660(%%rsi);"
-		"MOVDQA %%xmm3, 0x0670(%%rsi);"
-		"MOVNTDQA 0x0680(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0690(%%rax), %%xmm1;"
-		"MOVNTDQA 0x06a0(%%rax), %%xmm2;"
-		"MOVNTDQA 0x06b0(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0680(%%rsi);"
-		"MOVDQA %%xmm1, 0x0690(%%rsi);"
-		"MOVDQA %%xmm2, 0x06a0(%%rsi);"
-		"MOVDQA %%xmm3, 0x06b0(%%rsi);"
-		"MOVNTDQA 0x06c0(%%rax), %%xmm0;"
-		"MOVNTDQA 0x06d0(%%rax), %%xmm1;"
-		"MOVNTDQA 0x06e0(%%rax), %%xmm2;"
-		"MOVNTDQA 0x06f0(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x06c0(%%rsi);"
-		"MOVDQA %%xmm1, 0x06d0(%%rsi);"
-		"MOVDQA %%xmm2, 0x06e0(%%rsi);"
-		"MOVDQA %%xmm3, 0x06f0(%%rsi);"
-		"MOVNTDQA 0x0700(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0710(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0720(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0730(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0700(%%rsi);"
-		"MOVDQA %%xmm1, 0x0710(%%rsi);"
-		"MOVDQA %%xmm2, 0x0720(%%rsi);"
-		"MOVDQA %%xmm3, 0x0730(%%rsi);"
-		"MOVNTDQA 0x0740(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0750(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0760(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0770(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0740(%%rsi);"
-		"MOVDQA %%xmm1, 0x0750(%%rsi);"
-		"MOVDQA %%xmm2, 0x0760(%%rsi);"
-		"MOVDQA %%xmm3, 0x0770(%%rsi);"
-		"MOVNTDQA 0x0780(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0790(%%rax), %%xmm1;"
-		"MOVNTDQA 0x07a0(%%rax), %%xmm2;"
-		"MOVNTDQA 0x07b0(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0780(%%rsi);"
-		"MOVDQA %%xmm1, 0x0790(%%rsi);"
-		"MOVDQA %%xmm2, 0x07a0(%%rsi);"
-		"MOVDQA %%xmm3, 0x07b0(%%rsi);"
-		"MOVNTDQA 0x07c0(%%rax), %%xmm0;"
-		"MOVNTDQA 0x07d0(%%rax), %%xmm1;"
-		"MOVNTDQA 0x07e0(%%rax), %%xmm2;"
-		"MOVNTDQA 0x07f0(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x07c0(%%rsi);"
-		"MOVDQA %%xmm1, 0x07d0(%%rsi);"
-		"MOVDQA %%xmm2, 0x07e0(%%rsi);"
-		"MOVDQA %%xmm3, 0x07f0(%%rsi);"
-		"MOVNTDQA 0x0800(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0810(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0820(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0830(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0800(%%rsi);"
-		"MOVDQA %%xmm1, 0x0810(%%rsi);"
-		"MOVDQA %%xmm2, 0x0820(%%rsi);"
-		"MOVDQA %%xmm3, 0x0830(%%rsi);"
-		"MOVNTDQA 0x0840(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0850(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0860(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0870(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0840(%%rsi);"
-		"MOVDQA %%xmm1, 0x0850(%%rsi);"
-		"MOVDQA %%xmm2, 0x0860(%%rsi);"
-		"MOVDQA %%xmm3, 0x0870(%%rsi);"
-		"MOVNTDQA 0x0880(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0890(%%rax), %%xmm1;"
-		"MOVNTDQA 0x08a0(%%rax), %%xmm2;"
-		"MOVNTDQA 0x08b0(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0880(%%rsi);"
-		"MOVDQA %%xmm1, 0x0890(%%rsi);"
-		"MOVDQA %%xmm2, 0x08a0(%%rsi);"
-		"MOVDQA %%xmm3, 0x08b0(%%rsi);"
-		"MOVNTDQA 0x08c0(%%rax), %%xmm0;"
-		"MOVNTDQA 0x08d0(%%rax), %%xmm1;"
-		"MOVNTDQA 0x08e0(%%rax), %%xmm2;"
-		"MOVNTDQA 0x08f0(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x08c0(%%rsi);"
-		"MOVDQA %%xmm1, 0x08d0(%%rsi);"
-		"MOVDQA %%xmm2, 0x08e0(%%rsi);"
-		"MOVDQA %%xmm3, 0x08f0(%%rsi);"
-		"MOVNTDQA 0x0900(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0910(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0920(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0930(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0900(%%rsi);"
-		"MOVDQA %%xmm1, 0x0910(%%rsi);"
-		"MOVDQA %%xmm2, 0x0920(%%rsi);"
-		"MOVDQA %%xmm3, 0x0930(%%rsi);"
-		"MOVNTDQA 0x0940(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0950(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0960(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0970(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0940(%%rsi);"
-		"MOVDQA %%xmm1, 0x0950(%%rsi);"
-		"MOVDQA %%xmm2, 0x0960(%%rsi);"
-		"MOVDQA %%xmm3, 0x0970(%%rsi);"
-		"MOVNTDQA 0x0980(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0990(%%rax), %%xmm1;"
-		"MOVNTDQA 0x09a0(%%rax), %%xmm2;"
-		"MOVNTDQA 0x09b0(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0980(%%rsi);"
-		"MOVDQA %%xmm1, 0x0990(%%rsi);"
-		"MOVDQA %%xmm2, 0x09a0(%%rsi);"
-		"MOVDQA %%xmm3, 0x09b0(%%rsi);"
-		"MOVNTDQA 0x09c0(%%rax), %%xmm0;"
-		"MOVNTDQA 0x09d0(%%rax), %%xmm1;"
-		"MOVNTDQA 0x09e0(%%rax), %%xmm2;"
-		"MOVNTDQA 0x09f0(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x09c0(%%rsi);"
-		"MOVDQA %%xmm1, 0x09d0(%%rsi);"
-		"MOVDQA %%xmm2, 0x09e0(%%rsi);"
-		"MOVDQA %%xmm3, 0x09f0(%%rsi);"
-		"MOVNTDQA 0x0a00(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0a10(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0a20(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0a30(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0a00(%%rsi);"
-		"MOVDQA %%xmm1, 0x0a10(%%rsi);"
-		"MOVDQA %%xmm2, 0x0a20(%%rsi);"
-		"MOVDQA %%xmm3, 0x0a30(%%rsi);"
-		"MOVNTDQA 0x0a40(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0a50(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0a60(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0a70(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0a40(%%rsi);"
-		"MOVDQA %%xmm1, 0x0a50(%%rsi);"
-		"MOVDQA %%xmm2, 0x0a60(%%rsi);"
-		"MOVDQA %%xmm3, 0x0a70(%%rsi);"
-		"MOVNTDQA 0x0a80(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0a90(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0aa0(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0ab0(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0a80(%%rsi);"
-		"MOVDQA %%xmm1, 0x0a90(%%rsi);"
-		"MOVDQA %%xmm2, 0x0aa0(%%rsi);"
-		"MOVDQA %%xmm3, 0x0ab0(%%rsi);"
-		"MOVNTDQA 0x0ac0(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0ad0(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0ae0(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0af0(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0ac0(%%rsi);"
-		"MOVDQA %%xmm1, 0x0ad0(%%rsi);"
-		"MOVDQA %%xmm2, 0x0ae0(%%rsi);"
-		"MOVDQA %%xmm3, 0x0af0(%%rsi);"
-		"MOVNTDQA 0x0b00(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0b10(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0b20(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0b30(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0b00(%%rsi);"
-		"MOVDQA %%xmm1, 0x0b10(%%rsi);"
-		"MOVDQA %%xmm2, 0x0b20(%%rsi);"
-		"MOVDQA %%xmm3, 0x0b30(%%rsi);"
-		"MOVNTDQA 0x0b40(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0b50(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0b60(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0b70(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0b40(%%rsi);"
-		"MOVDQA %%xmm1, 0x0b50(%%rsi);"
-		"MOVDQA %%xmm2, 0x0b60(%%rsi);"
-		"MOVDQA %%xmm3, 0x0b70(%%rsi);"
-		"MOVNTDQA 0x0b80(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0b90(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0ba0(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0bb0(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0b80(%%rsi);"
-		"MOVDQA %%xmm1, 0x0b90(%%rsi);"
-		"MOVDQA %%xmm2, 0x0ba0(%%rsi);"
-		"MOVDQA %%xmm3, 0x0bb0(%%rsi);"
-		"MOVNTDQA 0x0bc0(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0bd0(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0be0(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0bf0(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0bc0(%%rsi);"
-		"MOVDQA %%xmm1, 0x0bd0(%%rsi);"
-		"MOVDQA %%xmm2, 0x0be0(%%rsi);"
-		"MOVDQA %%xmm3, 0x0bf0(%%rsi);"
-		"MOVNTDQA 0x0c00(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0c10(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0c20(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0c30(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0c00(%%rsi);"
-		"MOVDQA %%xmm1, 0x0c10(%%rsi);"
-		"MOVDQA %%xmm2, 0x0c20(%%rsi);"
-		"MOVDQA %%xmm3, 0x0c30(%%rsi);"
-		"MOVNTDQA 0x0c40(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0c50(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0c60(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0c70(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0c40(%%rsi);"
-		"MOVDQA %%xmm1, 0x0c50(%%rsi);"
-		"MOVDQA %%xmm2, 0x0c60(%%rsi);"
-		"MOVDQA %%xmm3, 0x0c70(%%rsi);"
-		"MOVNTDQA 0x0c80(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0c90(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0ca0(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0cb0(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0c80(%%rsi);"
-		"MOVDQA %%xmm1, 0x0c90(%%rsi);"
-		"MOVDQA %%xmm2, 0x0ca0(%%rsi);"
-		"MOVDQA %%xmm3, 0x0cb0(%%rsi);"
-		"MOVNTDQA 0x0cc0(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0cd0(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0ce0(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0cf0(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0cc0(%%rsi);"
-		"MOVDQA %%xmm1, 0x0cd0(%%rsi);"
-		"MOVDQA %%xmm2, 0x0ce0(%%rsi);"
-		"MOVDQA %%xmm3, 0x0cf0(%%rsi);"
-		"MOVNTDQA 0x0d00(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0d10(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0d20(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0d30(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0d00(%%rsi);"
-		"MOVDQA %%xmm1, 0x0d10(%%rsi);"
-		"MOVDQA %%xmm2, 0x0d20(%%rsi);"
-		"MOVDQA %%xmm3, 0x0d30(%%rsi);"
-		"MOVNTDQA 0x0d40(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0d50(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0d60(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0d70(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0d40(%%rsi);"
-		"MOVDQA %%xmm1, 0x0d50(%%rsi);"
-		"MOVDQA %%xmm2, 0x0d60(%%rsi);"
-		"MOVDQA %%xmm3, 0x0d70(%%rsi);"
-		"MOVNTDQA 0x0d80(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0d90(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0da0(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0db0(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0d80(%%rsi);"
-		"MOVDQA %%xmm1, 0x0d90(%%rsi);"
-		"MOVDQA %%xmm2, 0x0da0(%%rsi);"
-		"MOVDQA %%xmm3, 0x0db0(%%rsi);"
-		"MOVNTDQA 0x0dc0(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0dd0(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0de0(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0df0(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0dc0(%%rsi);"
-		"MOVDQA %%xmm1, 0x0dd0(%%rsi);"
-		"MOVDQA %%xmm2, 0x0de0(%%rsi);"
-		"MOVDQA %%xmm3, 0x0df0(%%rsi);"
-		"MOVNTDQA 0x0e00(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0e10(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0e20(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0e30(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0e00(%%rsi);"
-		"MOVDQA %%xmm1, 0x0e10(%%rsi);"
-		"MOVDQA %%xmm2, 0x0e20(%%rsi);"
-		"MOVDQA %%xmm3, 0x0e30(%%rsi);"
-		"MOVNTDQA 0x0e40(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0e50(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0e60(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0e70(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0e40(%%rsi);"
-		"MOVDQA %%xmm1, 0x0e50(%%rsi);"
-		"MOVDQA %%xmm2, 0x0e60(%%rsi);"
-		"MOVDQA %%xmm3, 0x0e70(%%rsi);"
-		"MOVNTDQA 0x0e80(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0e90(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0ea0(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0eb0(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0e80(%%rsi);"
-		"MOVDQA %%xmm1, 0x0e90(%%rsi);"
-		"MOVDQA %%xmm2, 0x0ea0(%%rsi);"
-		"MOVDQA %%xmm3, 0x0eb0(%%rsi);"
-		"MOVNTDQA 0x0ec0(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0ed0(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0ee0(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0ef0(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0ec0(%%rsi);"
-		"MOVDQA %%xmm1, 0x0ed0(%%rsi);"
-		"MOVDQA %%xmm2, 0x0ee0(%%rsi);"
-		"MOVDQA %%xmm3, 0x0ef0(%%rsi);"
-		"MOVNTDQA 0x0f00(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0f10(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0f20(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0f30(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0f00(%%rsi);"
-		"MOVDQA %%xmm1, 0x0f10(%%rsi);"
-		"MOVDQA %%xmm2, 0x0f20(%%rsi);"
-		"MOVDQA %%xmm3, 0x0f30(%%rsi);"
-		"MOVNTDQA 0x0f40(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0f50(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0f60(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0f70(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0f40(%%rsi);"
-		"MOVDQA %%xmm1, 0x0f50(%%rsi);"
-		"MOVDQA %%xmm2, 0x0f60(%%rsi);"
-		"MOVDQA %%xmm3, 0x0f70(%%rsi);"
-		"MOVNTDQA 0x0f80(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0f90(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0fa0(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0fb0(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0f80(%%rsi);"
-		"MOVDQA %%xmm1, 0x0f90(%%rsi);"
-		"MOVDQA %%xmm2, 0x0fa0(%%rsi);"
-		"MOVDQA %%xmm3, 0x0fb0(%%rsi);"
-		"MOVNTDQA 0x0fc0(%%rax), %%xmm0;"
-		"MOVNTDQA 0x0fd0(%%rax), %%xmm1;"
-		"MOVNTDQA 0x0fe0(%%rax), %%xmm2;"
-		"MOVNTDQA 0x0ff0(%%rax), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0fc0(%%rsi);"
-		"MOVDQA %%xmm1, 0x0fd0(%%rsi);"
-		"MOVDQA %%xmm2, 0x0fe0(%%rsi);"
-		"MOVDQA %%xmm3, 0x0ff0(%%rsi);"
-
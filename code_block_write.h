@@ -1,519 +0,0 @@
-		"MOVNTDQA 0x0000(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0010(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0020(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0030(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0000(%%rax);"
-		"MOVDQA %%xmm1, 0x0010(%%rax);"
-		"MOVDQA %%xmm2, 0x0020(%%rax);"
-		"MOVDQA %%xmm3, 0x0030(%%rax);"
-		"MFENCE;"
-		"MOVNTDQA 0x0040(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0050(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0060(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0070(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0040(%%rax);"
-		"MOVDQA %%xmm1, 0x0050(%%rax);"
-		"MOVDQA %%xmm2, 0x0060(%%rax);"
-		"MOVDQA %%xmm3, 0x0070(%%rax);"
-		"MFENCE;"
-		"MOVNTDQA 0x0080(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0090(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x00a0(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x00b0(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0080(%%rax);"
-		"MOVDQA %%xmm1, 0x0090(%%rax);"
-		"MOVDQA %%xmm2, 0x00a0(%%rax);"
-		"MOVDQA %%xmm3, 0x00b0(%%rax);"
-		"MFENCE;"
-		"MOVNTDQA 0x00c0(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x00d0(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x00e0(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x00f0(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x00c0(%%rax);"
-		"MOVDQA %%xmm1, 0x00d0(%%rax);"
-		"MOVDQA %%xmm2, 0x00e0(%%rax);"
-		"MOVDQA %%xmm3, 0x00f0(%%rax);"
-		"MFENCE;"
-		"MOVNTDQA 0x0100(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0110(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0120(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0130(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0100(%%rax);"
-		"MOVDQA %%xmm1, 0x0110(%%rax);"
-		"MOVDQA %%xmm2, 0x0120(%%rax);"
-		"MOVDQA %%xmm3, 0x0130(%%rax);"
-		"MFENCE;"
-		"MOVNTDQA 0x0140(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0150(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0160(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0170(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0140(%%rax);"
-		"MOVDQA %%xmm1, 0x0150(%%rax);"
-		"MOVDQA %%xmm2, 0x0160(%%rax);"
-		"MOVDQA %%xmm3, 0x0170(%%rax);"
-		"MFENCE;"
-		"MOVNTDQA 0x0180(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0190(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x01a0(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x01b0(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0180(%%rax);"
-		"MOVDQA %%xmm1, 0x0190(%%rax);"
-		"MOVDQA %%xmm2, 0x01a0(%%rax);"
-		"MOVDQA %%xmm3, 0x01b0(%%rax);"
-		"MOVNTDQA 0x01c0(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x01d0(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x01e0(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x01f0(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x01c0(%%rax);"
-		"MOVDQA %%xmm1, 0x01d0(%%rax);"
-		"MOVDQA %%xmm2, 0x01e0(%%rax);"
-		"MOVDQA %%xmm3, 0x01f0(%%rax);"
-		"MOVNTDQA 0x0200(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0210(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0220(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0230(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0200(%%rax);"
-		"MOVDQA %%xmm1, 0x0210(%%rax);"
-		"MOVDQA %%xmm2, 0x0220(%%rax);"
-		"MOVDQA %%xmm3, 0x0230(%%rax);"
-		"MOVNTDQA 0x0240(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0250(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0260(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0270(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0240(%%rax);"
-		"MOVDQA %%xmm1, 0x0250(%%rax);"
-		"MOVDQA %%xmm2, 0x0260(%%rax);"
-		"MOVDQA %%xmm3, 0x0270(%%rax);"
-		"MOVNTDQA 0x0280(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0290(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x02a0(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x02b0(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0280(%%rax);"
-		"MOVDQA %%xmm1, 0x0290(%%rax);"
-		"MOVDQA %%xmm2, 0x02a0(%%rax);"
-		"MOVDQA %%xmm3, 0x02b0(%%rax);"
-		"MOVNTDQA 0x02c0(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x02d0(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x02e0(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x02f0(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x02c0(%%rax);"
-		"MOVDQA %%xmm1, 0x02d0(%%rax);"
-		"MOVDQA %%xmm2, 0x02e0(%%rax);"
-		"MOVDQA %%xmm3, 0x02f0(%%rax);"
-		"MOVNTDQA 0x0300(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0310(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0320(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0330(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0300(%%rax);"
-		"MOVDQA %%xmm1, 0x0310(%%rax);"
-		"MOVDQA %%xmm2, 0x0320(%%rax);"
-		"MOVDQA %%xmm3, 0x0330(%%rax);"
-		"MOVNTDQA 0x0340(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0350(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0360(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0370(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0340(%%rax);"
-		"MOVDQA %%xmm1, 0x0350(%%rax);"
-		"MOVDQA %%xmm2, 0x0360(%%rax);"
-		"MOVDQA %%xmm3, 0x0370(%%rax);"
-		"MOVNTDQA 0x0380(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0390(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x03a0(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x03b0(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0380(%%rax);"
-		"MOVDQA %%xmm1, 0x0390(%%rax);"
-		"MOVDQA %%xmm2, 0x03a0(%%rax);"
-		"MOVDQA %%xmm3, 0x03b0(%%rax);"
-		"MOVNTDQA 0x03c0(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x03d0(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x03e0(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x03f0(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x03c0(%%rax);"
-		"MOVDQA %%xmm1, 0x03d0(%%rax);"
-		"MOVDQA %%xmm2, 0x03e0(%%rax);"
-		"MOVDQA %%xmm3, 0x03f0(%%rax);"
-		"MOVNTDQA 0x0400(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0410(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0420(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0430(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0400(%%rax);"
-		"MOVDQA %%xmm1, 0x0410(%%rax);"
-		"MOVDQA %%xmm2, 0x0420(%%rax);"
-		"MOVDQA %%xmm3, 0x0430(%%rax);"
-		"MOVNTDQA 0x0440(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0450(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0460(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0470(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0440(%%rax);"
-		"MOVDQA %%xmm1, 0x0450(%%rax);"
-		"MOVDQA %%xmm2, 0x0460(%%rax);"
-		"MOVDQA %%xmm3, 0x0470(%%rax);"
-		"MOVNTDQA 0x0480(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0490(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x04a0(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x04b0(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0480(%%rax);"
-		"MOVDQA %%xmm1, 0x0490(%%rax);"
-		"MOVDQA %%xmm2, 0x04a0(%%rax);"
-		"MOVDQA %%xmm3, 0x04b0(%%rax);"
-		"MOVNTDQA 0x04c0(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x04d0(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x04e0(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x04f0(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x04c0(%%rax);"
-		"MOVDQA %%xmm1, 0x04d0(%%rax);"
-		"MOVDQA %%xmm2, 0x04e0(%%rax);"
-		"MOVDQA %%xmm3, 0x04f0(%%rax);"
-		"MOVNTDQA 0x0500(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0510(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0520(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0530(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0500(%%rax);"
-		"MOVDQA %%xmm1, 0x0510(%%rax);"
-		"MOVDQA %%xmm2, 0x0520(%%rax);"
-		"MOVDQA %%xmm3, 0x0530(%%rax);"
-		"MOVNTDQA 0x0540(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0550(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0560(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0570(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0540(%%rax);"
-		"MOVDQA %%xmm1, 0x0550(%%rax);"
-		"MOVDQA %%xmm2, 0x0560(%%rax);"
-		"MOVDQA %%xmm3, 0x0570(%%rax);"
-		"MOVNTDQA 0x0580(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0590(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x05a0(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x05b0(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0580(%%rax);"
-		"MOVDQA %%xmm1, 0x0590(%%rax);"
-		"MOVDQA %%xmm2, 0x05a0(%%rax);"
-		"MOVDQA %%xmm3, 0x05b0(%%rax);"
-		"MOVNTDQA 0x05c0(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x05d0(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x05e0(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x05f0(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x05c0(%%rax);"
-		"MOVDQA %%xmm1, 0x05d0(%%rax);"
-		"MOVDQA %%xmm2, 0x05e0(%%rax);"
-		"MOVDQA %%xmm3, 0x05f0(%%rax);"
-		"MOVNTDQA 0x0600(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0610(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0620(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0630(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0600(%%rax);"
-		"MOVDQA %%xmm1, 0x0610(%%rax);"
-		"MOVDQA %%xmm2, 0x0620(%%rax);"
-		"MOVDQA %%xmm3, 0x0630(%%rax);"
-		"MOVNTDQA 0x0640(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0650(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0660(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0670(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0640(%%rax);"
-		"MOVDQA %%xmm1, 0x0650(%%rax);"
-		"MOVDQA %%xmm2, 0x0660(%%rax);"
-		"MOVDQA %%xmm3, 0x0670(%%rax);"
-		"MOVNTDQA 0x0680(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0690(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x06a0(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x06b0(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0680(%%rax);"
-		"MOVDQA %%xmm1, 0x0690(%%rax);"
-		"MOVDQA %%xmm2, 0x06a0(%%rax);"
-		"MOVDQA %%xmm3, 0x06b0(%%rax);"
-		"MOVNTDQA 0x06c0(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x06d0(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x06e0(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x06f0(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x06c0(%%rax);"
-		"MOVDQA %%xmm1, 0x06d0(%%rax);"
-		"MOVDQA %%xmm2, 0x06e0(%%rax);"
-		"MOVDQA %%xmm3, 0x06f0(%%rax);"
-		"MOVNTDQA 0x0700(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0710(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0720(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0730(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0700(%%rax);"
-		"MOVDQA %%xmm1, 0x0710(%%rax);"
-		"MOVDQA %%xmm2, 0x0720(%%rax);"
-		"MOVDQA %%xmm3, 0x0730(%%rax);"
-		"MOVNTDQA 0x0740(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0750(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0760(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0770(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0740(%%rax);"
-		"MOVDQA %%xmm1, 0x0750(%%rax);"
-		"MOVDQA %%xmm2, 0x0760(%%rax);"
-		"MOVDQA %%xmm3, 0x0770(%%rax);"
-		"MOVNTDQA 0x0780(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0790(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x07a0(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x07b0(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0780(%%rax);"
-		"MOVDQA %%xmm1, 0x0790(%%rax);"
-		"MOVDQA %%xmm2, 0x07a0(%%rax);"
-		"MOVDQA %%xmm3, 0x07b0(%%rax);"
-		"MOVNTDQA 0x07c0(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x07d0(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x07e0(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x07f0(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x07c0(%%rax);"
-		"MOVDQA %%xmm1, 0x07d0(%%rax);"
-		"MOVDQA %%xmm2, 0x07e0(%%rax);"
-		"MOVDQA %%xmm3, 0x07f0(%%rax);"
-		"MOVNTDQA 0x0800(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0810(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0820(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0830(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0800(%%rax);"
-		"MOVDQA %%xmm1, 0x0810(%%rax);"
-		"MOVDQA %%xmm2, 0x0820(%%rax);"
-		"MOVDQA %%xmm3, 0x0830(%%rax);"
-		"MOVNTDQA 0x0840(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0850(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0860(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0870(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0840(%%rax);"
-		"MOVDQA %%xmm1, 0x0850(%%rax);"
-		"MOVDQA %%xmm2, 0x0860(%%rax);"
-		"MOVDQA %%xmm3, 0x0870(%%rax);"
-		"MOVNTDQA 0x0880(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0890(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x08a0(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x08b0(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0880(%%rax);"
-		"MOVDQA %%xmm1, 0x0890(%%rax);"
-		"MOVDQA %%xmm2, 0x08a0(%%rax);"
-		"MOVDQA %%xmm3, 0x08b0(%%rax);"
-		"MOVNTDQA 0x08c0(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x08d0(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x08e0(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x08f0(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x08c0(%%rax);"
-		"MOVDQA %%xmm1, 0x08d0(%%rax);"
-		"MOVDQA %%xmm2, 0x08e0(%%rax);"
-		"MOVDQA %%xmm3, 0x08f0(%%rax);"
-		"MOVNTDQA 0x0900(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0910(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0920(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0930(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0900(%%rax);"
-		"MOVDQA %%xmm1, 0x0910(%%rax);"
-		"MOVDQA %%xmm2, 0x0920(%%rax);"
-		"MOVDQA %%xmm3, 0x0930(%%rax);"
-		"MOVNTDQA 0x0940(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0950(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0960(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0970(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0940(%%rax);"
-		"MOVDQA %%xmm1, 0x0950(%%rax);"
-		"MOVDQA %%xmm2, 0x0960(%%rax);"
-		"MOVDQA %%xmm3, 0x0970(%%rax);"
-		"MOVNTDQA 0x0980(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0990(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x09a0(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x09b0(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0980(%%rax);"
-		"MOVDQA %%xmm1, 0x0990(%%rax);"
-		"MOVDQA %%xmm2, 0x09a0(%%rax);"
-		"MOVDQA %%xmm3, 0x09b0(%%rax);"
-		"MOVNTDQA 0x09c0(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x09d0(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x09e0(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x09f0(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x09c0(%%rax);"
-		"MOVDQA %%xmm1, 0x09d0(%%rax);"
-		"MOVDQA %%xmm2, 0x09e0(%%rax);"
-		"MOVDQA %%xmm3, 0x09f0(%%rax);"
-		"MOVNTDQA 0x0a00(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0a10(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0a20(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0a30(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0a00(%%rax);"
-		"MOVDQA %%xmm1, 0x0a10(%%rax);"
-		"MOVDQA %%xmm2, 0x0a20(%%rax);"
-		"MOVDQA %%xmm3, 0x0a30(%%rax);"
-		"MOVNTDQA 0x0a40(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0a50(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0a60(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0a70(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0a40(%%rax);"
-		"MOVDQA %%xmm1, 0x0a50(%%rax);"
-		"MOVDQA %%xmm2, 0x0a60(%%rax);"
-		"MOVDQA %%xmm3, 0x0a70(%%rax);"
-		"MOVNTDQA 0x0a80(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0a90(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0aa0(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0ab0(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0a80(%%rax);"
-		"MOVDQA %%xmm1, 0x0a90(%%rax);"
-		"MOVDQA %%xmm2, 0x0aa0(%%rax);"
-		"MOVDQA %%xmm3, 0x0ab0(%%rax);"
-		"MOVNTDQA 0x0ac0(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0ad0(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0ae0(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0af0(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0ac0(%%rax);"
-		"MOVDQA %%xmm1, 0x0ad0(%%rax);"
-		"MOVDQA %%xmm2, 0x0ae0(%%rax);"
-		"MOVDQA %%xmm3, 0x0af0(%%rax);"
-		"MOVNTDQA 0x0b00(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0b10(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0b20(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0b30(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0b00(%%rax);"
-		"MOVDQA %%xmm1, 0x0b10(%%rax);"
-		"MOVDQA %%xmm2, 0x0b20(%%rax);"
-		"MOVDQA %%xmm3, 0x0b30(%%rax);"
-		"MOVNTDQA 0x0b40(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0b50(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0b60(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0b70(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0b40(%%rax);"
-		"MOVDQA %%xmm1, 0x0b50(%%rax);"
-		"MOVDQA %%xmm2, 0x0b60(%%rax);"
-		"MOVDQA %%xmm3, 0x0b70(%%rax);"
-		"MOVNTDQA 0x0b80(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0b90(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0ba0(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0bb0(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0b80(%%rax);"
-		"MOVDQA %%xmm1, 0x0b90(%%rax);"
-		"MOVDQA %%xmm2, 0x0ba0(%%rax);"
-		"MOVDQA %%xmm3, 0x0bb0(%%rax);"
-		"MOVNTDQA 0x0bc0(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0bd0(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0be0(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0bf0(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0bc0(%%rax);"
-		"MOVDQA %%xmm1, 0x0bd0(%%rax);"
-		"MOVDQA %%xmm2, 0x0be0(%%rax);"
-		"MOVDQA %%xmm3, 0x0bf0(%%rax);"
-		"MOVNTDQA 0x0c00(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0c10(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0c20(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0c30(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0c00(%%rax);"
-		"MOVDQA %%xmm1, 0x0c10(%%rax);"
-		"MOVDQA %%xmm2, 0x0c20(%%rax);"
-		"MOVDQA %%xmm3, 0x0c30(%%rax);"
-		"MOVNTDQA 0x0c40(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0c50(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0c60(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0c70(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0c40(%%rax);"
-		"MOVDQA %%xmm1, 0x0c50(%%rax);"
-		"MOVDQA %%xmm2, 0x0c60(%%rax);"
-		"MOVDQA %%xmm3, 0x0c70(%%rax);"
-		"MOVNTDQA 0x0c80(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0c90(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0ca0(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0cb0(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0c80(%%rax);"
-		"MOVDQA %%xmm1, 0x0c90(%%rax);"
-		"MOVDQA %%xmm2, 0x0ca0(%%rax);"
-		"MOVDQA %%xmm3, 0x0cb0(%%rax);"
-		"MOVNTDQA 0x0cc0(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0cd0(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0ce0(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0cf0(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0cc0(%%rax);"
-		"MOVDQA %%xmm1, 0x0cd0(%%rax);"
-		"MOVDQA %%xmm2, 0x0ce0(%%rax);"
-		"MOVDQA %%xmm3, 0x0cf0(%%rax);"
-		"MOVNTDQA 0x0d00(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0d10(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0d20(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0d30(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0d00(%%rax);"
-		"MOVDQA %%xmm1, 0x0d10(%%rax);"
-		"MOVDQA %%xmm2, 0x0d20(%%rax);"
-		"MOVDQA %%xmm3, 0x0d30(%%rax);"
-		"MOVNTDQA 0x0d40(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0d50(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0d60(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0d70(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0d40(%%rax);"
-		"MOVDQA %%xmm1, 0x0d50(%%rax);"
-		"MOVDQA %%xmm2, 0x0d60(%%rax);"
-		"MOVDQA %%xmm3, 0x0d70(%%rax);"
-		"MOVNTDQA 0x0d80(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0d90(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0da0(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0db0(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0d80(%%rax);"
-		"MOVDQA %%xmm1, 0x0d90(%%rax);"
-		"MOVDQA %%xmm2, 0x0da0(%%rax);"
-		"MOVDQA %%xmm3, 0x0db0(%%rax);"
-		"MOVNTDQA 0x0dc0(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0dd0(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0de0(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0df0(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0dc0(%%rax);"
-		"MOVDQA %%xmm1, 0x0dd0(%%rax);"
-		"MOVDQA %%xmm2, 0x0de0(%%rax);"
-		"MOVDQA %%xmm3, 0x0df0(%%rax);"
-		"MOVNTDQA 0x0e00(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0e10(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0e20(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0e30(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0e00(%%rax);"
-		"MOVDQA %%xmm1, 0x0e10(%%rax);"
-		"MOVDQA %%xmm2, 0x0e20(%%rax);"
-		"MOVDQA %%xmm3, 0x0e30(%%rax);"
-		"MOVNTDQA 0x0e40(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0e50(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0e60(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0e70(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0e40(%%rax);"
-		"MOVDQA %%xmm1, 0x0e50(%%rax);"
-		"MOVDQA %%xmm2, 0x0e60(%%rax);"
-		"MOVDQA %%xmm3, 0x0e70(%%rax);"
-		"MOVNTDQA 0x0e80(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0e90(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0ea0(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0eb0(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0e80(%%rax);"
-		"MOVDQA %%xmm1, 0x0e90(%%rax);"
-		"MOVDQA %%xmm2, 0x0ea0(%%rax);"
-		"MOVDQA %%xmm3, 0x0eb0(%%rax);"
-		"MOVNTDQA 0x0ec0(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0ed0(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0ee0(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0ef0(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0ec0(%%rax);"
-		"MOVDQA %%xmm1, 0x0ed0(%%rax);"
-		"MOVDQA %%xmm2, 0x0ee0(%%rax);"
-		"MOVDQA %%xmm3, 0x0ef0(%%rax);"
-		"MOVNTDQA 0x0f00(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0f10(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0f20(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0f30(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0f00(%%rax);"
-		"MOVDQA %%xmm1, 0x0f10(%%rax);"
-		"MOVDQA %%xmm2, 0x0f20(%%rax);"
-		"MOVDQA %%xmm3, 0x0f30(%%rax);"
-		"MOVNTDQA 0x0f40(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0f50(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0f60(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0f70(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0f40(%%rax);"
-		"MOVDQA %%xmm1, 0x0f50(%%rax);"
-		"MOVDQA %%xmm2, 0x0f60(%%rax);"
-		"MOVDQA %%xmm3, 0x0f70(%%rax);"
-		"MOVNTDQA 0x0f80(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0f90(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0fa0(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0fb0(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0f80(%%rax);"
-		"MOVDQA %%xmm1, 0x0f90(%%rax);"
-		"MOVDQA %%xmm2, 0x0fa0(%%rax);"
-		"MOVDQA %%xmm3, 0x0fb0(%%rax);"
-		"MOVNTDQA 0x0fc0(%%rsi), %%xmm0;"
-		"MOVNTDQA 0x0fd0(%%rsi), %%xmm1;"
-		"MOVNTDQA 0x0fe0(%%rsi), %%xmm2;"
-		"MOVNTDQA 0x0ff0(%%rsi), %%xmm3;"
-		"MOVDQA %%xmm0, 0x0fc0(%%rax);"
-		"MOVDQA %%xmm1, 0x0fd0(%%rax);"
-		"MOVDQA %%xmm2, 0x0fe0(%%rax);"
-		"MOVDQA %%xmm3, 0x0ff0(%%rax);"
-
@@ -10,10 +10,10 @@
 //		sudo rdmsr 0x198  // tests the rdmsr library
 //
 // To Compile with another program using these routines (example.c for example):
-// 		gcc -Wall -W -Werror -g example.c samkit.c -lpci -lm -o example
+// 		gcc -Wall -W -Werror -g example.c samkit.c -lpci -lm -lpthread -o example
 //
 //	32 bit compile:
-// 		gcc -m32 -Wall -W -Werror -g example.c samkit.c -lpci -lm -o example
+// 		gcc -m32 -Wall -W -Werror -g example.c samkit.c -lpci -lm -lpthread -o example
 //
 // To Run:
 // 		sudo modprobe msr
@@ -43,6 +43,7 @@
  */
 // ==========================================================
 
+#define _GNU_SOURCE		// pthread_attr_setaffinity_np, CPU_SET
 #include <sys/mman.h>
 #include <pci/pci.h>    // ** Must use -lm compile option **
 #include <fcntl.h>
@@ -55,6 +56,11 @@
 #include <string.h>     // for strlen
 #include <math.h>       // need for pow (exponent) ** Must use -lm compile option **
 #include <sys/io.h>		// Permits access to IO Locations
+#include <pthread.h>		// ** Must use -lpthread compile option **
+#include <dirent.h>		// opendir (sysfs scans)
+#include <time.h>		// clock_gettime (TSC calibration)
+#include <sched.h>		// sched_yield
+#include <signal.h>		// sigaction (Ctrl-C ends a watch)
 
 //===========================================================
 // Sam Routines
@@ -63,781 +69,2592 @@
 //===========================================================
 // Defines
 #define FATAL do { fprintf(stderr, "Error at line %d, file %s (%d) [%s]\n", \
-  __LINE__, __FILE__, errno, strerror(errno)); exit(1); } while(0)
+  __LINE__, __FILE__, errno, strerror(errno)); fatal_exit(); } while(0)
  
+//===========================================================
+// FATAL Recovery
+//===========================================================
+// FATAL always meant exit(1):  fine for one command per process, but it ends a whole shell or
+// script over one bad address.  SHF_fatal_hook lets the caller catch it instead (samtool's hook
+// longjmps back to the command loop).  Only the thread that set the hook gets it - a FATAL in a
+// worker thread still exits, since there's nothing there to jump back to.
+static void (*fatal_hook)(void) = NULL;
+static pthread_t fatal_hook_thread;
+
+void SHF_fatal_hook(void (*hook)(void))
+{
+	fatal_hook = hook;
+	fatal_hook_thread = pthread_self();
+}
+
+static void fatal_exit(void)
+{
+	if ( (fatal_hook != NULL) && (pthread_equal(pthread_self(), fatal_hook_thread)) )
+		fatal_hook();								// Doesn't come back
+	exit(1);
+}
+
 //#define MAP_SIZE 4086UL (this failed on address 0xFFFFFFF1 [but is what code pulled from inet had!])
 #define MAP_SIZE 4096UL
 #define MAP_MASK (MAP_SIZE - 1)
 
 
 //===========================================================
+// PCI Session
 //===========================================================
-u8 SHFpci_read_byte(unsigned long bus, unsigned long device, unsigned long function, unsigned long reg)
-{
-   struct pci_access *pacc = pci_alloc();
-   struct pci_dev *dev;
-   unsigned long am_range;
+// Every SHFpci_ routine used to do pci_alloc/pci_init/pci_get_dev/pci_cleanup for ONE
+// register.  A 4K device dump re-initialized libpci 4096 times.  Now there is one
+// pci_access for the whole process, and the pci_dev handles are cached (hashed on
+// domain/bus/device/function) the first time they are asked for.
+#define PCI_DEV_CACHE_BUCKETS 256
 
-   // Get rid of warnings.  I hate warnings
-   bus=bus;    device = device;    function = function;    reg = reg;
+struct pci_dev_cache_entry
+	{
+	unsigned int domain;
+	unsigned int bus;
+	unsigned int device;
+	unsigned int function;
+	struct pci_dev *dev;
+	int config_fd;				// /sys/bus/pci/devices/.../config (-1 = not opened yet, -2 = not available)
+	struct pci_dev_cache_entry *next;
+	};
 
-   pci_init(pacc);
-   dev = pci_get_dev(pacc, 0x00, bus, device, function); if (dev == NULL) {printf("Error in pci_get_dev call\n");}
+static struct pci_access *pci_session = NULL;
+static struct pci_dev_cache_entry *pci_dev_cache[PCI_DEV_CACHE_BUCKETS];
 
-   am_range = (int)pci_read_byte(dev, reg);
 
-   pci_cleanup(pacc);
-   return am_range;
+//===========================================================
+//===========================================================
+struct pci_access *SHFpci_session_open(void)
+{
+	if (pci_session == NULL)
+		{
+		pci_session = pci_alloc();
+		pci_init(pci_session);
+		atexit(SHFpci_session_close);
+		}
+	return pci_session;
 }
 
 
 //===========================================================
 //===========================================================
-u32 SHFpci_read_dword(unsigned long bus, unsigned long device, unsigned long function, unsigned long reg)
+void SHFpci_session_close(void)
 {
-   struct pci_access *pacc = pci_alloc();
-   struct pci_dev *dev;
-   unsigned long am_range;
-
-   // Get rid of warnings.  I hate warnings
-   bus=bus;    device = device;    function = function;    reg = reg;
-
-   pci_init(pacc);
-   dev = pci_get_dev(pacc, 0x00, bus, device, function); if (dev == NULL) {printf("Error in pci_get_dev call\n");}
+	struct pci_dev_cache_entry *entry, *next;
+	int i;
 
-   // If user inputs a non-dword aligned value, align it!
-   reg = (reg / 4) * 4;
+	if (pci_session == NULL)
+		return;
 
-   am_range = pci_read_long(dev, reg);
+	for (i=0; i<PCI_DEV_CACHE_BUCKETS; i++)
+		{
+		for (entry = pci_dev_cache[i]; entry != NULL; entry = next)
+			{
+			next = entry->next;
+			if (entry->config_fd >= 0)
+				close(entry->config_fd);
+			pci_free_dev(entry->dev);
+			free(entry);
+			}
+		pci_dev_cache[i] = NULL;
+		}
 
-   pci_cleanup(pacc);
-   return am_range;
+	pci_cleanup(pci_session);
+	pci_session = NULL;
 }
 
 
 //===========================================================
 //===========================================================
-u16 SHFpci_read_word(unsigned long bus, unsigned long device, unsigned long function, unsigned long reg)
+static struct pci_dev_cache_entry *pci_dev_cache_lookup(unsigned int domain, unsigned long bus, unsigned long device, unsigned long function)
 {
-   struct pci_access *pacc = pci_alloc();
-   struct pci_dev *dev;
-   u16 am_range;
-
-   // Get rid of warnings.  I hate warnings
-   bus=bus;    device = device;    function = function;    reg = reg;
+	struct pci_dev_cache_entry *entry;
+	unsigned int bucket;
 
-   pci_init(pacc);
-   dev = pci_get_dev(pacc, 0x00, bus, device, function); if (dev == NULL) {printf("Error in pci_get_dev call\n");}
+	bucket = (bus ^ (device << 3) ^ function ^ domain) % PCI_DEV_CACHE_BUCKETS;
 
-   // If user inputs a non-dword aligned value, align it!
-   reg = (reg / 2) * 2;
+	for (entry = pci_dev_cache[bucket]; entry != NULL; entry = entry->next)
+		{
+		if ( (entry->domain == domain) && (entry->bus == bus) &&
+			  (entry->device == device) && (entry->function == function) )
+			return entry;
+		}
 
-   am_range = pci_read_word(dev, reg);
+	entry = malloc(sizeof(struct pci_dev_cache_entry));
+	if (entry == NULL)
+		return NULL;
 
-   pci_cleanup(pacc);
-   return am_range;
+	entry->dev = pci_get_dev(SHFpci_session_open(), domain, bus, device, function);
+	if (entry->dev == NULL)
+		{
+		free(entry);
+		return NULL;
+		}
+	entry->domain = domain;
+	entry->bus = bus;
+	entry->device = device;
+	entry->function = function;
+	entry->config_fd = -1;
+	entry->next = pci_dev_cache[bucket];
+	pci_dev_cache[bucket] = entry;
+
+	return entry;
 }
 
 
 //===========================================================
 //===========================================================
-void SHFpci_write_byte(unsigned long bus, unsigned long device, unsigned long function, unsigned long reg, u8 u8_data)
+struct pci_dev *SHFpci_get_dev(unsigned int domain, unsigned long bus, unsigned long device, unsigned long function)
 {
-	struct pci_access *pacc = pci_alloc();
-	struct pci_dev *dev;
+	struct pci_dev_cache_entry *entry;
 
-	pci_init(pacc);
-	// dev = pci_get_dev(pacc, domain=0, bus,  device, function);
-	dev =    pci_get_dev(pacc, 0x00,     bus,  device, function);
-	if (dev == NULL) {
-		printf("Failure in pci_get_dev routine; SHFpci_write_byte");
-	}
+	entry = pci_dev_cache_lookup(domain, bus, device, function);
+	if (entry == NULL)
+		return NULL;
+	return entry->dev;
+}
 
-	pci_write_byte(dev, reg, u8_data);
-	pci_cleanup(pacc);
 
-return;
-}
+//===========================================================
+// ECAM (MMCONFIG) Config Space
+//===========================================================
+// libpci's default method is a syscall (or two) per register.  If the ACPI MCFG table
+// is there, we map the ECAM windows through /dev/mem and config reads/writes become plain
+// loads/stores.  Each window (segment) is mapped whole, once, and kept - not through the
+// SHFmem_map LRU, where one 1MB mapping per bus would thrash past 32 buses.  It's only
+// address space (up to 256MB a segment); nothing is touched until a register is.  If the
+// whole window won't map, it falls back to a bus at a time through SHFmem_map.  libpci
+// is still the fallback for anything the MCFG doesn't cover or that we can't map.
+#define ECAM_MAX_WINDOWS 32
+
+struct ecam_window
+	{
+	u64 base;					// Physical address of bus 0 for this segment
+	unsigned int segment;	// PCI domain
+	unsigned int start_bus;
+	unsigned int end_bus;
+	int verified;				// 0 = not checked yet, 1 = agrees with libpci, -1 = don't use
+	volatile u8 *map;			// start_bus..end_bus, mapped whole (NULL = not yet, or per bus)
+	int map_failed;			// 1 = whole window wouldn't map, go a bus at a time
+	};
+
+static struct ecam_window ecam_windows[ECAM_MAX_WINDOWS];
+static int ecam_window_count = -1;		// -1 = MCFG not parsed yet
+static int ecam_enabled = 1;
 
 
 //===========================================================
 //===========================================================
-void SHFpci_write_word(unsigned long bus, unsigned long device, unsigned long function, unsigned long reg, u16 u16_data)
+// MCFG:  36 byte ACPI header, 8 reserved bytes, then 16 byte entries of
+//   u64 base, u16 segment, u8 start bus, u8 end bus, u32 reserved
+static void ecam_parse_mcfg(void)
 {
-	struct pci_access *pacc = pci_alloc();
-	struct pci_dev *dev;
+	u8 table[44 + (ECAM_MAX_WINDOWS * 16)];
+	u32 table_length;
+	ssize_t got;
+	int fd, i;
 
-	pci_init(pacc);
-	// dev = pci_get_dev(pacc, domain=0, bus,  device, function);
-	dev =    pci_get_dev(pacc, 0x00,     bus,  device, function);
-	if (dev == NULL) {
-		printf("Failure in pci_get_dev routine; SHFpci_write_byte");
-	}
+	ecam_window_count = 0;
 
-	pci_write_word(dev, reg, u16_data);
-	pci_cleanup(pacc);
+	fd = open("/sys/firmware/acpi/tables/MCFG", O_RDONLY);
+	if (fd == -1)
+		return;
+	got = read(fd, table, sizeof(table));
+	close(fd);
 
-return;
+	if ( (got < 44) || (strncmp((char *)table, "MCFG", 4) != 0) )
+		return;
+	memcpy(&table_length, &table[4], sizeof(table_length));
+	if (table_length < (u32)got)
+		got = table_length;
+
+	for (i=0; (i < ECAM_MAX_WINDOWS) && ((44 + (i+1)*16) <= got); i++)
+		{
+		memcpy(&ecam_windows[i].base, &table[44 + i*16], 8);
+		ecam_windows[i].segment   = table[44 + i*16 + 8] | (table[44 + i*16 + 9] << 8);
+		ecam_windows[i].start_bus = table[44 + i*16 + 10];
+		ecam_windows[i].end_bus   = table[44 + i*16 + 11];
+		ecam_windows[i].verified  = 0;
+		ecam_windows[i].map       = NULL;
+		ecam_windows[i].map_failed = 0;
+		}
+	ecam_window_count = i;
 }
 
 
 //===========================================================
 //===========================================================
-void SHFpci_write_dword(unsigned long bus, unsigned long device, unsigned long function, unsigned long reg, u32 u32_data)
+void SHFpci_use_ecam(int enable)
 {
-	struct pci_access *pacc = pci_alloc();
-	struct pci_dev *dev;
+	ecam_enabled = enable;
+}
 
-	pci_init(pacc);
-	// dev = pci_get_dev(pacc, domain=0, bus,  device, function);
-	dev =    pci_get_dev(pacc, 0x00,     bus,  device, function);
-	if (dev == NULL) {
-		printf("Failure in pci_get_dev routine; SHFpci_write_byte");
-	}
 
-	pci_write_long(dev, reg, u32_data);
-	pci_cleanup(pacc);
+//===========================================================
+//===========================================================
+// Start of a bus in the window's ECAM.  The whole window is mapped the first time, else
+// (it wouldn't map) the bus's 1MB through SHFmem_map.  NULL if neither works.
+static volatile u8 *ecam_bus(struct ecam_window *window, unsigned long bus)
+{
+	void *map_base;
+	u64 size;
+	int fd;
 
-return;
+	if ( (window->map == NULL) && (!window->map_failed) )
+		{
+		window->map_failed = 1;
+		size = (u64)(window->end_bus - window->start_bus + 1) << 20;
+		fd = open("/dev/mem", O_RDWR | O_SYNC);
+		if (fd != -1)
+			{
+			map_base = mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, (off_t)(window->base + ((u64)window->start_bus << 20)));
+			close(fd);							// The mapping doesn't need it
+			if (map_base != MAP_FAILED)
+				{
+				window->map = map_base;
+				window->map_failed = 0;
+				}
+			}
+		}
+
+	if (window->map != NULL)
+		return window->map + ((bus - window->start_bus) << 20);
+	return SHFmem_map(window->base + (bus << 20), 0x100000);
 }
 
 
-// *** BUG ***
-// it looks like the "virt_addr = map_base + (target & MAP_MASK)" portion of code
-// must be 16 byte aligned.  Getting crashes with anything that doesn't end in 0.
 //===========================================================
 //===========================================================
-u8 SHFmem_read_byte(u64 passed_address)
+// Returns a pointer to the config register through ECAM, or NULL if the caller
+// needs to go through libpci instead.
+static volatile void *ecam_address(unsigned int domain, unsigned long bus, unsigned long device, unsigned long function, unsigned long reg)
 {
-	u8 u8_data;
-	u64 aligned_address, offset;
+	struct ecam_window *window = NULL;
+	struct pci_dev *dev;
+	volatile u32 *check;
+	volatile u8 *bus_base;
+	int i;
 
-	int fd; 
-  	void *map_base, *virt_addr; 
-	unsigned long read_result; 
-	off_t target;
+	if ( (!ecam_enabled) || (reg >= 0x1000) || (device > 0x1F) || (function > 0x07) )
+		return NULL;
+	if (ecam_window_count == -1)
+		ecam_parse_mcfg();
 
-	aligned_address = passed_address & 0xFFFFFFF0;
-	offset = passed_address - aligned_address;	// 0x00 through 0x0F
-	
-	target = (off_t)(aligned_address);
+	for (i=0; i<ecam_window_count; i++)
+		{
+		if ( (ecam_windows[i].segment == domain) &&
+			  (bus >= ecam_windows[i].start_bus) && (bus <= ecam_windows[i].end_bus) )
+			{
+			window = &ecam_windows[i];
+			break;
+			}
+		}
+	if ( (window == NULL) || (window->verified == -1) )
+		return NULL;
 
-	if((fd = open("/dev/mem", O_RDWR | O_SYNC)) == -1) FATAL;
-	fflush(stdout);
-    
-	// Map one page
-	map_base = mmap(0, MAP_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, target & ~MAP_MASK);
-	if(map_base == (void *) -1) 
+	bus_base = ecam_bus(window, bus);
+	if (bus_base == NULL)
 		{
-      printf("Address we tried to pass:\t0x%lX\n", target);
-		FATAL;
+		window->verified = -1;
+		return NULL;
 		}
 
-	virt_addr = map_base + (target & MAP_MASK);
+	// First time through a window, make sure it agrees with libpci (ID of the first device
+	// on the first bus) before we trust it.  If it doesn't, we never use it again.
+	if (window->verified == 0)
+		{
+		dev = SHFpci_get_dev(domain, window->start_bus, 0, 0);
+		check = (volatile u32 *)ecam_bus(window, window->start_bus);
+		if ( (dev != NULL) && (check != NULL) && (*check == pci_read_long(dev, 0x00)) )
+			window->verified = 1;
+		else
+			{
+			window->verified = -1;
+			return NULL;
+			}
+		// Going a bus at a time, the check may have evicted the bus mapping - look it up again
+		bus_base = ecam_bus(window, bus);
+		if (bus_base == NULL)
+			return NULL;
+		}
 
-//	read_result = *((unsigned char *) (virt_addr + offset));
-	read_result = *((u8 *) (virt_addr + offset));
-	u8_data = read_result;
+	return bus_base + (device << 15) + (function << 12) + reg;
+}
 
-	fflush(stdout);
-	if(munmap(map_base, MAP_SIZE) == -1) FATAL;
-	close(fd);
 
-return u8_data;
+//===========================================================
+//===========================================================
+// sysfs config file for a cached device, opened the first time it's needed.
+// Returns -1 if there isn't one (device not present, no sysfs, etc.)
+static int pci_config_fd(struct pci_dev_cache_entry *entry)
+{
+	char config_name[100];
+
+	if (entry->config_fd == -1)
+		{
+		snprintf(config_name, sizeof(config_name), "/sys/bus/pci/devices/%04x:%02x:%02x.%x/config",
+				entry->domain, entry->bus, entry->device, entry->function);
+		entry->config_fd = open(config_name, O_RDWR);
+		if (entry->config_fd == -1)
+			entry->config_fd = open(config_name, O_RDONLY);
+		if (entry->config_fd == -1)
+			entry->config_fd = -2;
+		}
+
+	if (entry->config_fd < 0)
+		return -1;
+	return entry->config_fd;
 }
 
 
 //===========================================================
 //===========================================================
-u16 SHFmem_read_word(u64 passed_address)
+int SHFpci_read_block(unsigned long bus, unsigned long device, unsigned long function, unsigned long reg, u8 *buffer, unsigned long length)
 {
-	u16 u16_data;
-	u64 aligned_address, offset;
+	struct pci_dev_cache_entry *entry;
+	volatile void *cfg;
+	ssize_t done = 0;
+	unsigned long i;
+	int fd;
+
+	// ECAM:  just copy it out (dwords when we can, bytes otherwise)
+	cfg = ecam_address(0x00, bus, device, function, reg);
+	if ( (cfg != NULL) && ((reg + length) <= 0x1000) )
+		{
+		if ( ((reg % 4) == 0) && ((length % 4) == 0) )
+			for (i=0; i<length; i=i+4)
+				*((u32 *)(buffer + i)) = *((volatile u32 *)(cfg + i));
+		else
+			for (i=0; i<length; i++)
+				buffer[i] = *((volatile u8 *)(cfg + i));
+		return length;
+		}
 
-	int fd; 
-  	void *map_base, *virt_addr; 
-	unsigned long read_result; 
-	off_t target;
-	
-	aligned_address = passed_address & 0xFFFFFFF0;
-	offset = passed_address - aligned_address;	// 0x00 through 0x0F
-	
-	target = (off_t)(aligned_address);
+	entry = pci_dev_cache_lookup(0x00, bus, device, function);
+	if (entry == NULL) {printf("Error in pci_get_dev call\n"); return -1;}
 
-	if((fd = open("/dev/mem", O_RDWR | O_SYNC)) == -1) FATAL;
-	fflush(stdout);
-    
-	// Map one page
-	map_base = mmap(0, MAP_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, target & ~MAP_MASK);
-	if(map_base == (void *) -1) 
+	// One pread does the whole range (as root).  Non-root only gets the first 64 bytes.
+	fd = pci_config_fd(entry);
+	if (fd >= 0)
 		{
-      printf("Address we tried to pass:\t0x%lX\n", target);
-		FATAL;
+		done = pread(fd, buffer, length, reg);
+		if (done < 0)
+			done = 0;
 		}
 
-	virt_addr = map_base + (target & MAP_MASK);
-//	read_result = *((unsigned short *) (virt_addr + offset));
-	read_result = *((u16 *) (virt_addr + offset));
-	u16_data = read_result;
-
-	fflush(stdout);
-	if(munmap(map_base, MAP_SIZE) == -1) FATAL;
-	close(fd);
+	// Whatever sysfs didn't give us, ask libpci for
+	if ((unsigned long)done < length)
+		{
+		if (pci_read_block(entry->dev, reg + done, buffer + done, length - done))
+			done = length;
+		else
+			memset(buffer + done, 0xFF, length - done);
+		}
 
-	return u16_data;
+	return done;
 }
 
 
 //===========================================================
 //===========================================================
-u32 SHFmem_read_dword(u64 passed_address)
+int SHFpci_write_block(unsigned long bus, unsigned long device, unsigned long function, unsigned long reg, u8 *buffer, unsigned long length)
 {
-	u32 u32_data;
-	u64 aligned_address, offset;
+	struct pci_dev_cache_entry *entry;
+	volatile void *cfg;
+	ssize_t done = 0;
+	unsigned long i;
+	int fd;
+
+	cfg = ecam_address(0x00, bus, device, function, reg);
+	if ( (cfg != NULL) && ((reg + length) <= 0x1000) )
+		{
+		if ( ((reg % 4) == 0) && ((length % 4) == 0) )
+			for (i=0; i<length; i=i+4)
+				*((volatile u32 *)(cfg + i)) = *((u32 *)(buffer + i));
+		else
+			for (i=0; i<length; i++)
+				*((volatile u8 *)(cfg + i)) = buffer[i];
+		return length;
+		}
 
-	int fd; 
-  	void *map_base, *virt_addr; 
-	unsigned long read_result; 
-	off_t target;
-	
-	aligned_address = passed_address & 0xFFFFFFF0;
-	offset = passed_address - aligned_address;	// 0x00 through 0x0F
-	
-	target = (off_t)(aligned_address);
+	entry = pci_dev_cache_lookup(0x00, bus, device, function);
+	if (entry == NULL) {printf("Failure in pci_get_dev routine; SHFpci_write_block"); return -1;}
 
-	if((fd = open("/dev/mem", O_RDWR | O_SYNC)) == -1) FATAL;
-	fflush(stdout);
-    
-	// Map one page
-	map_base = mmap(0, MAP_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, target & ~MAP_MASK);
-	if(map_base == (void *) -1) 
+	fd = pci_config_fd(entry);
+	if (fd >= 0)
 		{
-      printf("Address we tried to pass:\t0x%lX\n", target);
-		FATAL;
+		done = pwrite(fd, buffer, length, reg);
+		if (done < 0)
+			done = 0;
 		}
 
-	virt_addr = map_base + (target & MAP_MASK);
-//	read_result = *((unsigned long *) (virt_addr + offset));
-	read_result = *((u32 *) (virt_addr + offset));
-	u32_data = read_result;
-
-	fflush(stdout);
-	if(munmap(map_base, MAP_SIZE) == -1) FATAL;
-	close(fd);
+	if ((unsigned long)done < length)
+		{
+		if (pci_write_block(entry->dev, reg + done, buffer + done, length - done))
+			done = length;
+		}
 
-	return u32_data;
+	return done;
 }
 
 
 //===========================================================
 //===========================================================
-u64 SHFmem_read_qword(u64 passed_address)
+u8 SHFpci_read_byte(unsigned long bus, unsigned long device, unsigned long function, unsigned long reg)
 {
-	u64 u64_data;
-	u64 aligned_address, offset;
+	struct pci_dev *dev;
+	volatile void *cfg;
 
-	int fd; 
-  	void *map_base, *virt_addr; 
-	unsigned long read_result; 
-	off_t target;
-	
-	aligned_address = passed_address & 0xFFFFFFF0;
-	offset = passed_address - aligned_address;	// 0x00 through 0x0F
-	
-	target = (off_t)(aligned_address);
+	cfg = ecam_address(0x00, bus, device, function, reg);
+	if (cfg != NULL)
+		return *((volatile u8 *)cfg);
 
-	if((fd = open("/dev/mem", O_RDWR | O_SYNC)) == -1) FATAL;
-	fflush(stdout);
-    
-	// Map one page
-	map_base = mmap(0, MAP_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, target & ~MAP_MASK);
-	if(map_base == (void *) -1) 
-		{
-      printf("Address we tried to pass:\t0x%lX\n", target);
-		FATAL;
-		}
+	dev = SHFpci_get_dev(0x00, bus, device, function);
+	if (dev == NULL) {printf("Error in pci_get_dev call\n"); return 0xFF;}
 
-	virt_addr = map_base + (target & MAP_MASK);
-//	read_result = *((unsigned long *) (virt_addr + offset));
-	read_result = *((u64 *) (virt_addr + offset));
-	u64_data = read_result;
-	u64_data = *((u64 *) (virt_addr + offset));
+	return pci_read_byte(dev, reg);
+}
 
 
-	fflush(stdout);
-	if(munmap(map_base, MAP_SIZE) == -1) FATAL;
-	close(fd);
+//===========================================================
+//===========================================================
+u32 SHFpci_read_dword(unsigned long bus, unsigned long device, unsigned long function, unsigned long reg)
+{
+	struct pci_dev *dev;
+	volatile void *cfg;
+
+	// If user inputs a non-dword aligned value, align it!
+	reg = (reg / 4) * 4;
+
+	cfg = ecam_address(0x00, bus, device, function, reg);
+	if (cfg != NULL)
+		return *((volatile u32 *)cfg);
 
-	return u64_data;
+	dev = SHFpci_get_dev(0x00, bus, device, function);
+	if (dev == NULL) {printf("Error in pci_get_dev call\n"); return 0xFFFFFFFF;}
+
+	return pci_read_long(dev, reg);
 }
 
 
 //===========================================================
 //===========================================================
-void SHFmem_write_byte  (u64 passed_address, u8 u8_data)
+u16 SHFpci_read_word(unsigned long bus, unsigned long device, unsigned long function, unsigned long reg)
 {
-	int fd; 
-  	void *map_base, *virt_addr; 
-	off_t target;
-	u64 aligned_address, offset;
-
-	aligned_address = passed_address & 0xFFFFFFF0;
-	offset = passed_address - aligned_address;	// 0x00 through 0x0F
-	target = (off_t)(aligned_address);
+	struct pci_dev *dev;
+	volatile void *cfg;
 
-	if((fd = open("/dev/mem", O_RDWR | O_SYNC)) == -1) FATAL;
-	fflush(stdout);
-    
-	// Map one page
-	map_base = mmap(0, MAP_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, target & ~MAP_MASK);
-	if(map_base == (void *) -1) 
-		{
-      printf("SHFmem_write_byte:  Address we tried to pass:\t0x%lX\n", target);
-		FATAL;
-		}
+	// If user inputs a non-dword aligned value, align it!
+	reg = (reg / 2) * 2;
 
-	virt_addr = map_base + (target & MAP_MASK);
-	*((u8*)(virt_addr + offset)) = u8_data;
+	cfg = ecam_address(0x00, bus, device, function, reg);
+	if (cfg != NULL)
+		return *((volatile u16 *)cfg);
 
-	fflush(stdout);
-	if(munmap(map_base, MAP_SIZE) == -1) FATAL;
-	close(fd);
+	dev = SHFpci_get_dev(0x00, bus, device, function);
+	if (dev == NULL) {printf("Error in pci_get_dev call\n"); return 0xFFFF;}
 
-	return;
+	return pci_read_word(dev, reg);
 }
 
 
 //===========================================================
 //===========================================================
-void SHFmem_write_word  (u64 passed_address, u16 u16_data)
+void SHFpci_write_byte(unsigned long bus, unsigned long device, unsigned long function, unsigned long reg, u8 u8_data)
 {
-	int fd; 
-  	void *map_base, *virt_addr; 
-	off_t target;
-	u64 aligned_address, offset;
-	
-	aligned_address = passed_address & 0xFFFFFFF0;
-	offset = passed_address - aligned_address;	// 0x00 through 0x0F
-	target = (off_t)(aligned_address);
-		
-	if((fd = open("/dev/mem", O_RDWR | O_SYNC)) == -1) FATAL;
-	fflush(stdout);
-    
-	// Map one page
-	map_base = mmap(0, MAP_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, target & ~MAP_MASK);
-	if(map_base == (void *) -1) 
+	struct pci_dev *dev;
+	volatile void *cfg;
+
+	cfg = ecam_address(0x00, bus, device, function, reg);
+	if (cfg != NULL)
 		{
-      printf("SHFmem_write_word:  Address we tried to pass:\t0x%lX\n", target);
-		FATAL;
+		*((volatile u8 *)cfg) = u8_data;
+		return;
 		}
 
-	virt_addr = map_base + (target & MAP_MASK);
-	*((u16 *) (virt_addr+offset)) = u16_data;
+	dev = SHFpci_get_dev(0x00, bus, device, function);
+	if (dev == NULL) {
+		printf("Failure in pci_get_dev routine; SHFpci_write_byte");
+		return;
+	}
 
-	fflush(stdout);
-	if(munmap(map_base, MAP_SIZE) == -1) FATAL;
-	close(fd);
-	return;
+	pci_write_byte(dev, reg, u8_data);
+
+return;
 }
 
 
 //===========================================================
 //===========================================================
-void SHFmem_write_dword (u64 passed_address, u32 u32_data)
+void SHFpci_write_word(unsigned long bus, unsigned long device, unsigned long function, unsigned long reg, u16 u16_data)
 {
-	int fd; 
-  	void *map_base, *virt_addr; 
-	off_t target;
-	u64 aligned_address, offset;
-	
-	aligned_address = passed_address & 0xFFFFFFF0;
-	offset = passed_address - aligned_address;	// 0x00 through 0x0F
-	target = (off_t)(aligned_address);
-		
-	if((fd = open("/dev/mem", O_RDWR | O_SYNC)) == -1) FATAL;
-	fflush(stdout);
-    
-	// Map one page
-	map_base = mmap(0, MAP_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, target & ~MAP_MASK);
-	if(map_base == (void *) -1) 
+	struct pci_dev *dev;
+	volatile void *cfg;
+
+	cfg = ecam_address(0x00, bus, device, function, reg);
+	if (cfg != NULL)
 		{
-      printf("SHFmem_write_word:  Address we tried to pass:\t0x%lX\n", target);
-		FATAL;
+		*((volatile u16 *)cfg) = u16_data;
+		return;
 		}
 
-	virt_addr = map_base + (target & MAP_MASK);
-	*((u32 *) (virt_addr+offset)) = u32_data;
+	dev = SHFpci_get_dev(0x00, bus, device, function);
+	if (dev == NULL) {
+		printf("Failure in pci_get_dev routine; SHFpci_write_word");
+		return;
+	}
 
-	fflush(stdout);
-	if(munmap(map_base, MAP_SIZE) == -1) FATAL;
-	close(fd);
-	return;
+	pci_write_word(dev, reg, u16_data);
+
+return;
 }
 
 
-// I/O Read Routines
 //===========================================================
 //===========================================================
-u8 SHF_IO_read_byte(u64 passed_address)
-	{
-	u8 u8_data;
-	ioperm(passed_address, 0x01, 0x01);
-	u8_data = inb(passed_address);
-	ioperm(passed_address, 0x01, 0x00);
-	return u8_data;
-	}
+void SHFpci_write_dword(unsigned long bus, unsigned long device, unsigned long function, unsigned long reg, u32 u32_data)
+{
+	struct pci_dev *dev;
+	volatile void *cfg;
 
-u16 SHF_IO_read_word(u64 passed_address)
-	{
-	u16 u16_data;
-	ioperm(passed_address, 0x02, 0x01);
-	u16_data = inw(passed_address);
-	ioperm(passed_address, 0x02, 0x00);
-	return u16_data;
-	}
+	cfg = ecam_address(0x00, bus, device, function, reg);
+	if (cfg != NULL)
+		{
+		*((volatile u32 *)cfg) = u32_data;
+		return;
+		}
 
-u32 SHF_IO_read_dword(u64 passed_address)
-	{
-	u32 u32_data;
-	ioperm(passed_address, 0x04, 0x01);
-	u32_data = inl(passed_address);
-	ioperm(passed_address, 0x04, 0x00);
-	return u32_data;
+	dev = SHFpci_get_dev(0x00, bus, device, function);
+	if (dev == NULL) {
+		printf("Failure in pci_get_dev routine; SHFpci_write_dword");
+		return;
 	}
 
+	pci_write_long(dev, reg, u32_data);
+
+return;
+}
 
-// I/O Write Routines
 //===========================================================
+// /dev/mem Mapping Cache
 //===========================================================
-void SHF_IO_write_byte(u64 passed_address, u8 u8_data)
+// The SHFmem_* routines used to open /dev/mem, mmap one page, do ONE access, then
+// munmap and close.  Polling a register cost ~5 syscalls and a page fault per read.
+// Now we keep /dev/mem open for the life of the process and hang onto the last
+// MAP_CACHE_ENTRIES mappings (LRU).  Hitting an address that's already mapped is
+// just a load or store.
+#define MAP_CACHE_ENTRIES 32
+
+struct map_cache_entry
 	{
-	ioperm(passed_address, 0x01, 0x01);
-	outb(u8_data, passed_address);
-	ioperm(passed_address, 0x01, 0x00);
-	return;
-	}
+	u64 phys_base;				// Physical address of the first mapped page
+	u64 size;					// # of bytes mapped (0 = slot not in use)
+	void *virt_base;			// Where it landed in our address space
+	u64 last_used;				// LRU stamp
+	};
 
-void SHF_IO_write_word(u64 passed_address, u16 u16_data)
-	{
-	ioperm(passed_address, 0x02, 0x01);
-	outw(u16_data, passed_address);
-	ioperm(passed_address, 0x02, 0x00);
-	return;
-	}
+static int mem_fd = -1;
+static struct map_cache_entry map_cache[MAP_CACHE_ENTRIES];
+static u64 map_cache_clock = 0;
 
-void SHF_IO_write_dword(u64 passed_address, u32 u32_data)
-	{
-	ioperm(passed_address, 0x04, 0x01);
-	outl(u32_data, passed_address);
-	ioperm(passed_address, 0x04, 0x00);
-	return;
-	}
 
+//===========================================================
+//===========================================================
+void *SHFmem_map(u64 passed_address, u64 length)
+{
+	u64 page_base, page_end;
+	void *map_base;
+	int i, victim;
+
+	if (length == 0)
+		length = 1;
+	page_base = passed_address & ~((u64)MAP_MASK);
+	page_end  = (passed_address + length + MAP_MASK) & ~((u64)MAP_MASK);
+
+	// Already have it?
+	for (i=0; i<MAP_CACHE_ENTRIES; i++)
+		{
+		if ( (map_cache[i].size != 0) && (page_base >= map_cache[i].phys_base) &&
+			  (page_end <= (map_cache[i].phys_base + map_cache[i].size)) )
+			{
+			map_cache[i].last_used = ++map_cache_clock;
+			return map_cache[i].virt_base + (passed_address - map_cache[i].phys_base);
+			}
+		}
+
+	if (mem_fd == -1)
+		{
+		mem_fd = open("/dev/mem", O_RDWR | O_SYNC);
+		if (mem_fd == -1)
+			return NULL;
+		}
+
+	map_base = mmap(0, page_end - page_base, PROT_READ | PROT_WRITE, MAP_SHARED, mem_fd, (off_t)page_base);
+	if (map_base == MAP_FAILED)
+		return NULL;
+
+	// Take an empty slot if there is one, else kick out the least recently used
+	victim = 0;
+	for (i=0; i<MAP_CACHE_ENTRIES; i++)
+		{
+		if (map_cache[i].size == 0)
+			{
+			victim = i;
+			break;
+			}
+		if (map_cache[i].last_used < map_cache[victim].last_used)
+			victim = i;
+		}
+	if (map_cache[victim].size != 0)
+		munmap(map_cache[victim].virt_base, map_cache[victim].size);
+
+	map_cache[victim].phys_base = page_base;
+	map_cache[victim].size = page_end - page_base;
+	map_cache[victim].virt_base = map_base;
+	map_cache[victim].last_used = ++map_cache_clock;
+
+	return map_base + (passed_address - page_base);
+}
+
+
+//===========================================================
+//===========================================================
+void SHFmem_invalidate(u64 passed_address, u64 length)
+{
+	int i;
+
+	if (length == 0)
+		length = 1;
+
+	for (i=0; i<MAP_CACHE_ENTRIES; i++)
+		{
+		if ( (map_cache[i].size != 0) &&
+			  (passed_address < (map_cache[i].phys_base + map_cache[i].size)) &&
+			  ((passed_address + length) > map_cache[i].phys_base) )
+			{
+			munmap(map_cache[i].virt_base, map_cache[i].size);
+			map_cache[i].size = 0;
+			}
+		}
+}
+
+
+//===========================================================
+//===========================================================
+void SHFmem_flush(void)
+{
+	int i;
+
+	for (i=0; i<MAP_CACHE_ENTRIES; i++)
+		{
+		if (map_cache[i].size != 0)
+			munmap(map_cache[i].virt_base, map_cache[i].size);
+		map_cache[i].size = 0;
+		}
+
+	if (mem_fd != -1)
+		close(mem_fd);
+	mem_fd = -1;
+}
+
+
+//===========================================================
+//===========================================================
+// Common front end for the single-access routines below.  Dies (like it always has)
+// if the address can't be mapped.
+static volatile void *SHFmem_map_or_die(u64 passed_address, u64 length, char *caller)
+{
+	void *virt_addr;
+
+	virt_addr = SHFmem_map(passed_address, length);
+	if (virt_addr == NULL)
+		{
+		printf("%s:  Address we tried to pass:\t0x%llX\n", caller, (unsigned long long)passed_address);
+		FATAL;
+		}
+	return virt_addr;
+}
+
+
+//===========================================================
+//===========================================================
+u8 SHFmem_read_byte(u64 passed_address)
+{
+	return *((volatile u8 *) SHFmem_map_or_die(passed_address, sizeof(u8), "SHFmem_read_byte"));
+}
+
+
+//===========================================================
+//===========================================================
+u16 SHFmem_read_word(u64 passed_address)
+{
+	return *((volatile u16 *) SHFmem_map_or_die(passed_address, sizeof(u16), "SHFmem_read_word"));
+}
+
+
+//===========================================================
+//===========================================================
+u32 SHFmem_read_dword(u64 passed_address)
+{
+	return *((volatile u32 *) SHFmem_map_or_die(passed_address, sizeof(u32), "SHFmem_read_dword"));
+}
+
+
+//===========================================================
+//===========================================================
+u64 SHFmem_read_qword(u64 passed_address)
+{
+	return *((volatile u64 *) SHFmem_map_or_die(passed_address, sizeof(u64), "SHFmem_read_qword"));
+}
+
+
+//===========================================================
+//===========================================================
+void SHFmem_write_byte  (u64 passed_address, u8 u8_data)
+{
+	*((volatile u8 *) SHFmem_map_or_die(passed_address, sizeof(u8), "SHFmem_write_byte")) = u8_data;
+	return;
+}
+
+
+//===========================================================
+//===========================================================
+void SHFmem_write_word  (u64 passed_address, u16 u16_data)
+{
+	*((volatile u16 *) SHFmem_map_or_die(passed_address, sizeof(u16), "SHFmem_write_word")) = u16_data;
+	return;
+}
+
+
+//===========================================================
+//===========================================================
+void SHFmem_write_dword (u64 passed_address, u32 u32_data)
+{
+	*((volatile u32 *) SHFmem_map_or_die(passed_address, sizeof(u32), "SHFmem_write_dword")) = u32_data;
+	return;
+}
+
+
+//===========================================================
+// I/O Permission Cache
+//===========================================================
+// Every SHF_IO_ routine used to ioperm() the port on, do its one in/out, and ioperm() it off
+// again:  two syscalls around a sub-microsecond instruction.  Now permission is granted the
+// first time a port is touched and kept until SHF_IO_release.  Granted ports are remembered in
+// a bitmap of the whole 64K I/O space (ioperm covers all of it), so a port that's already been
+// granted costs one bit test.  Only the ports actually used are opened - never iopl(3).  Like
+// ioperm itself, this belongs to the calling thread (threads created after the grant inherit it).
+#define IO_PERM_PORTS	0x10000
+
+static u8 io_granted[IO_PERM_PORTS / 8];
+static int io_any_granted = 0;
+
+
+//===========================================================
+//===========================================================
+int SHF_IO_grant(u64 port, int length)
+{
+	u64 p;
+
+	if ( (length < 1) || ((port + length) > IO_PERM_PORTS) )
+		return -1;
+	for (p=port; p<(port + length); p++)
+		if (!(io_granted[p >> 3] & (1 << (p & 7))))
+			break;
+	if (p == (port + length))
+		return 0;								// Already have all of it
+
+	if (ioperm(port, length, 1) != 0)
+		return -1;
+	for (p=port; p<(port + length); p++)
+		io_granted[p >> 3] |= (1 << (p & 7));
+	io_any_granted = 1;
+	return 0;
+}
+
+
+//===========================================================
+//===========================================================
+void SHF_IO_release(void)
+{
+	if (io_any_granted)
+		ioperm(0, IO_PERM_PORTS, 0);
+	memset(io_granted, 0, sizeof(io_granted));
+	io_any_granted = 0;
+}
+
+
+//===========================================================
+//===========================================================
+// Used to ignore a failed ioperm and die with SIGSEGV on the in/out.  Now it says why.
+static void io_grant_or_die(u64 port, int length, char *caller)
+{
+	if (SHF_IO_grant(port, length) != 0)
+		{
+		printf("%s:  No permission for I/O port 0x%llX (root?)\n", caller, (unsigned long long)port);
+		FATAL;
+		}
+}
+
+
+// I/O Read Routines
+//===========================================================
+//===========================================================
+u8 SHF_IO_read_byte(u64 passed_address)
+	{
+	io_grant_or_die(passed_address, 0x01, "SHF_IO_read_byte");
+	return inb(passed_address);
+	}
+
+u16 SHF_IO_read_word(u64 passed_address)
+	{
+	io_grant_or_die(passed_address, 0x02, "SHF_IO_read_word");
+	return inw(passed_address);
+	}
+
+u32 SHF_IO_read_dword(u64 passed_address)
+	{
+	io_grant_or_die(passed_address, 0x04, "SHF_IO_read_dword");
+	return inl(passed_address);
+	}
+
+
+// I/O Write Routines
+//===========================================================
+//===========================================================
+void SHF_IO_write_byte(u64 passed_address, u8 u8_data)
+	{
+	io_grant_or_die(passed_address, 0x01, "SHF_IO_write_byte");
+	outb(u8_data, passed_address);
+	return;
+	}
+
+void SHF_IO_write_word(u64 passed_address, u16 u16_data)
+	{
+	io_grant_or_die(passed_address, 0x02, "SHF_IO_write_word");
+	outw(u16_data, passed_address);
+	return;
+	}
+
+void SHF_IO_write_dword(u64 passed_address, u32 u32_data)
+	{
+	io_grant_or_die(passed_address, 0x04, "SHF_IO_write_dword");
+	outl(u32_data, passed_address);
+	return;
+	}
+
+
+
+// MSR Routines
+//===========================================================
+//===========================================================
+// Originally posted by Alexander Weggerle (Intel) Wed, 02/08/2012 - 01:57 
+// http://software.intel.com/en-us/forums/topic/280098
+// NOTE:  The msr module must be loaded (SHF_msr_load_module does this once per process)
+// NOTE:  You MIGHT have to run sudo -s before running these commands
+//
+// The /dev/cpu/N/msr file for each CPU is opened the first time it's used and kept
+// open, so a read or write is one pread/pwrite.
+#define MSR_MAX_CPUS 1024
+
+static int msr_fds[MSR_MAX_CPUS];
+static int msr_fds_ready = 0;
+
+
+//===========================================================
+//===========================================================
+static void msr_name(int CPU_number, char *msrname, int length)
+{
+        #ifdef __ANDROID__
+                snprintf (msrname, length, "/dev/msr%d", CPU_number);
+        #else
+                snprintf (msrname, length, "/dev/cpu/%d/msr", CPU_number);
+        #endif
+}
+
+
+//===========================================================
+//===========================================================
+int SHF_msr_load_module(int nosudo)
+{
+        static int module_present = -1;		// -1 = not checked yet.  Only looked at again after the modprobe.
+        char msrname[100];
+
+        if (module_present != -1)
+                return (module_present) ? 0 : -1;
+
+        msr_name(0, msrname, sizeof(msrname));
+        module_present = (access(msrname, F_OK) == 0);
+        if (!module_present)
+                {
+                if (nosudo)
+                        system("modprobe msr");
+                else
+                        system("sudo modprobe msr");
+                module_present = (access(msrname, F_OK) == 0);
+                }
+
+        return (module_present) ? 0 : -1;
+}
+
+
+//===========================================================
+//===========================================================
+// Returns the (cached) fd for CPU_number's msr file, -1 if it can't be opened
+static int msr_open(int CPU_number)
+{
+        char msrname[100];
+        int fh, i;
+
+        if (!msr_fds_ready)
+                {
+                for (i=0; i<MSR_MAX_CPUS; i++)
+                        msr_fds[i] = -1;
+                msr_fds_ready = 1;
+                }
+
+        if ( (CPU_number >= 0) && (CPU_number < MSR_MAX_CPUS) && (msr_fds[CPU_number] != -1) )
+                return msr_fds[CPU_number];
+
+        msr_name(CPU_number, msrname, sizeof(msrname));
+        fh = open (msrname, O_RDWR);
+        if (fh == -1)
+                fh = open (msrname, O_RDONLY);		// Reads can still work
+        if (fh == -1) {
+                /* Something went wrong, just get out. */
+                printf("Open of msr dev= '%s' failed at %s %d\n", msrname, __FILE__, __LINE__);
+                printf("You may need to do (as root) 'sudo modprobe msr'\n");
+                return -1;
+        }
+
+        if ( (CPU_number >= 0) && (CPU_number < MSR_MAX_CPUS) )
+                msr_fds[CPU_number] = fh;
+        return fh;
+}
+
+
+//===========================================================
+//===========================================================
+static void msr_done(int CPU_number, int fh)
+{
+        // Only close it if it isn't one we're caching
+        if ( (CPU_number < 0) || (CPU_number >= MSR_MAX_CPUS) )
+                close (fh);
+}
+
+
+// MSR Read Routine
+//===========================================================
+//===========================================================
+int SHF_rdmsr (int CPU_number, unsigned int MsrNum, unsigned long long *MsrVal) {
+        unsigned long long MsrBuffer;
+        int fh;
+
+        fh = msr_open(CPU_number);
+        if (fh == -1)
+                return -1;
+
+        if (pread (fh, &MsrBuffer, sizeof(MsrBuffer), (off_t)MsrNum) != sizeof(MsrBuffer)) {
+                printf("rdmsr of CPU %d offset= 0x%x failed at %s %d\n",
+                CPU_number, MsrNum, __FILE__, __LINE__);
+                msr_done(CPU_number, fh);
+                return -1;
+        }
+        if (MsrVal!=0) *MsrVal = MsrBuffer;
+        msr_done(CPU_number, fh);
+        return 0;
+}
+
+
+// MSR Write Routine
+//===========================================================
+//===========================================================
+// This used to only read the MSR back into a buffer and set the buffer (never wrote anything),
+// so samtool shelled out to "sudo wrmsr".  It's a real pwrite now.
+int SHF_wrmsr (int CPU_number, unsigned int MsrNum, unsigned long long *MsrVal) {
+        int fh;
+
+        if (MsrVal == 0)
+                return -1;
+
+        fh = msr_open(CPU_number);
+        if (fh == -1)
+                return -1;
+
+        if (pwrite (fh, MsrVal, sizeof(*MsrVal), (off_t)MsrNum) != sizeof(*MsrVal)) {
+                printf("wrmsr of CPU %d offset= 0x%x failed at %s %d (%s)\n",
+                CPU_number, MsrNum, __FILE__, __LINE__, strerror(errno));
+                msr_done(CPU_number, fh);
+                return -1;
+        }
+        msr_done(CPU_number, fh);
+        return 0;
+}
+
+
+// Per-CPU MSR Engine
+//===========================================================
+//===========================================================
+// Reading an MSR on another CPU through /dev/cpu/N/msr makes the kernel send an IPI to
+// that CPU.  Doing it for every CPU one after another takes forever on big boxes.
+// Instead, we start one thread per target CPU, pinned to that CPU, and each thread
+// reads its own MSRs (kernel does them locally - no IPI).  All the msr files are
+// opened up front (and stay open - see msr_open).
+struct msr_cpu_job
+	{
+	int CPU_number;
+	unsigned int *msrs;
+	int msr_count;
+	unsigned long long *values;			// msr_count values for this CPU
+	int failures;
+	};
+
+
+//===========================================================
+//===========================================================
+static void *msr_cpu_worker(void *arg)
+{
+	struct msr_cpu_job *job = arg;
+	int i;
+
+	for (i=0; i<job->msr_count; i++)
+		if (SHF_rdmsr(job->CPU_number, job->msrs[i], &job->values[i]) != 0)
+			job->failures++;
+	return NULL;
+}
+
+
+//===========================================================
+//===========================================================
+int SHF_rdmsr_cpus(int *cpus, int cpu_count, unsigned int *msrs, int msr_count, unsigned long long *values)
+{
+	struct msr_cpu_job *jobs;
+	pthread_t *threads;
+	pthread_attr_t attr;
+	cpu_set_t cpu_set;
+	int *started;
+	int i, failures = 0;
+
+	jobs = calloc(cpu_count, sizeof(struct msr_cpu_job));
+	threads = calloc(cpu_count, sizeof(pthread_t));
+	started = calloc(cpu_count, sizeof(int));
+	if ( (jobs == NULL) || (threads == NULL) || (started == NULL) )
+		{
+		free(jobs); free(threads); free(started);
+		return -1;
+		}
+
+	// Open everything from here (msr_open's cache isn't thread safe)
+	for (i=0; i<cpu_count; i++)
+		{
+		jobs[i].CPU_number = cpus[i];
+		jobs[i].msrs = msrs;
+		jobs[i].msr_count = msr_count;
+		jobs[i].values = &values[i * msr_count];
+		if ( (cpus[i] >= MSR_MAX_CPUS) || (msr_open(cpus[i]) == -1) )
+			jobs[i].failures = msr_count;		// Can't be kept open (or at all) - skip it
+		}
+
+	for (i=0; i<cpu_count; i++)
+		{
+		if (jobs[i].failures != 0)
+			continue;
+		pthread_attr_init(&attr);
+		CPU_ZERO(&cpu_set);
+		CPU_SET(cpus[i], &cpu_set);
+		pthread_attr_setaffinity_np(&attr, sizeof(cpu_set), &cpu_set);
+		if (pthread_create(&threads[i], &attr, msr_cpu_worker, &jobs[i]) == 0)
+			started[i] = 1;
+		else
+			msr_cpu_worker(&jobs[i]);			// Couldn't pin (CPU offline?).  Read it from here.
+		pthread_attr_destroy(&attr);
+		}
+
+	for (i=0; i<cpu_count; i++)
+		{
+		if (started[i])
+			pthread_join(threads[i], NULL);
+		failures = failures + jobs[i].failures;
+		}
+
+	free(jobs);
+	free(threads);
+	free(started);
+	return failures;
+}
+
+
+//===========================================================
+//===========================================================
+int SHF_parse_cpu_list(char *list, int *cpus, int max_cpus)
+{
+	long first, last, cpu, online_count;
+	char online[256], *pEnd;
+	int count = 0;
+	FILE *fp;
+
+	// all = the CPUs that are online right now.  sysfs has them in this same list format (and
+	// knows about holes - 0-3,6-7).  No sysfs:  the first _SC_NPROCESSORS_ONLN of them.
+	if ( (strncmp(list, "ALL", 3) == 0) || (strncmp(list, "all", 3) == 0) )
+		{
+		fp = fopen("/sys/devices/system/cpu/online", "r");
+		if (fp != NULL)
+			{
+			if (fgets(online, sizeof(online), fp) == NULL)
+				online[0] = 0;
+			fclose(fp);
+			online[strcspn(online, "\r\n")] = 0;
+			if ( (online[0]) && ((count = SHF_parse_cpu_list(online, cpus, max_cpus)) > 0) )
+				return count;
+			count = 0;
+			}
+		online_count = sysconf(_SC_NPROCESSORS_ONLN);
+		for (cpu=0; (cpu < online_count) && (count < max_cpus); cpu++)
+			cpus[count++] = cpu;
+		return count;
+		}
+
+	while (*list)
+		{
+		first = strtol(list, &pEnd, 0);
+		if (pEnd == list)
+			return -1;
+		last = first;
+		if (*pEnd == '-')
+			{
+			list = pEnd + 1;
+			last = strtol(list, &pEnd, 0);
+			if (pEnd == list)
+				return -1;
+			}
+		for (cpu=first; (cpu <= last) && (count < max_cpus); cpu++)
+			cpus[count++] = cpu;
+		list = pEnd;
+		if (*list == ',')
+			list++;
+		else if (*list != '\0')
+			return -1;
+		}
+	return count;
+}
+
+
+//===========================================================
+//===========================================================
+void SHFprint(u64 number, int min_length, int base, char *before, char *after)
+// number - the input passed number
+// min_length = how many chars minimum you want to display.
+//		For example, number = 0x323.  min_length = 4.  Output = 0x0323
+//		base.  You want hexidecimal (16)?  Base 10 (10)?  Octal (8)?
+{
+	u64 divisor;
+	u64 digit;
+	int i;
+
+// I hate warnings
+	number = number;     
+	min_length = min_length;     
+	base = base;
+
+	printf("%s", before);
+
+	for (i=(min_length-1); i>=0 ;i--)
+		{
+		divisor = pow(base,i);
+		digit = (number/divisor);
+		number = number-(digit*divisor);
+		printf("%X", (unsigned int)digit);
+		}
+
+	printf("%s", after);
+
+
+	return;
+}
+
+
+//===========================================================
+//===========================================================
+u64 rdtsc(void)
+{
+	static u64 last;
+	u32 lo, hi;
+	u64 tsc;
+
+	last = last;
+
+	if (sizeof(long) == sizeof(u64)) 
+		{
+	   	asm volatile("rdtsc" : "=a" (lo), "=d" (hi));
+		return ((u64)(hi) << 32) | lo;
+		}
+	else 
+		{
+	   	asm volatile("rdtsc" : "=A" (tsc));
+		return tsc;
+		}
+}
+
+
+//===========================================================
+//===========================================================
+// TSC Frequency
+//===========================================================
+// Freq_Calc used to spin for 5 seconds against the HPET (which it also had to find through
+// RCBA every sample).  Most CPUs just tell us the answer, so try the fast ways first:
+//	1) CPUID 0x15:  TSC/crystal ratio * crystal Hz.  Exact, nothing to measure.
+//	2) ~20ms cross-calibration of the TSC against CLOCK_MONOTONIC_RAW.  Each end is bracketed
+//	   by two clock reads, so we know how wrong it can be.  If the nominal frequency (MSR 0xCE
+//	   or CPUID 0x16) falls inside that error, use the nominal number instead.
+//	3) The old HPET spin (shortened to 100ms), only if there's no usable clock.
+#define FREQ_CAL_NS	20000000LL	// Calibration window (20ms)
+#define FREQ_CAL_TRIES	5		// Best (narrowest) clock/TSC bracket out of this many
+
+static struct SHF_freq_info freq_info;
+static int freq_info_ready = 0;
+
+
+//===========================================================
+//===========================================================
+static void shf_cpuid(u32 leaf, u32 subleaf, u32 *eax, u32 *ebx, u32 *ecx, u32 *edx)
+{
+	asm volatile("cpuid" : "=a" (*eax), "=b" (*ebx), "=c" (*ecx), "=d" (*edx) : "a" (leaf), "c" (subleaf));
+}
+
+
+//===========================================================
+//===========================================================
+static long long freq_clock_ns(void)
+{
+	struct timespec ts;
+
+	if (clock_gettime(CLOCK_MONOTONIC_RAW, &ts) != 0)
+		return -1;
+	return ((long long)ts.tv_sec * 1000000000LL) + ts.tv_nsec;
+}
+
+
+//===========================================================
+//===========================================================
+// Samples the TSC between two clock reads (keeping the tightest of a few tries).
+// *ns = middle of the bracket, *width = bracket width.  Returns -1 if the clock doesn't work.
+static int freq_bracket(u64 *tsc, long long *ns, long long *width)
+{
+	long long before, after;
+	u64 t;
+	int i;
+
+	*width = -1;
+	for (i=0; i<FREQ_CAL_TRIES; i++)
+		{
+		before = freq_clock_ns();
+		t = rdtsc();
+		after = freq_clock_ns();
+		if ( (before < 0) || (after < before) )
+			return -1;
+		if ( (*width < 0) || ((after - before) < *width) )
+			{
+			*width = after - before;
+			*ns = before + ((after - before) / 2);
+			*tsc = t;
+			}
+		}
+	return 0;
+}
+
+
+//===========================================================
+//===========================================================
+// TSC vs. CLOCK_MONOTONIC_RAW.  Returns Hz (0 if the clock isn't usable), *error = +/- Hz
+static double freq_calibrate(double *error)
+{
+	u64 tsc0, tsc1;
+	long long ns0, ns1, w0, w1;
+	double frequency;
+
+	if (freq_bracket(&tsc0, &ns0, &w0) != 0)
+		return 0;
+	while (freq_clock_ns() - ns0 < FREQ_CAL_NS)
+		;
+	if ( (freq_bracket(&tsc1, &ns1, &w1) != 0) || (ns1 <= ns0) || (tsc1 <= tsc0) )
+		return 0;
+
+	frequency = (double)(tsc1 - tsc0) * 1000000000.0 / (double)(ns1 - ns0);
+
+	// Each sample can be off by half its bracket (plus a ns of clock granularity)
+	*error = frequency * ((double)(w0 + w1) / 2.0 + 1.0) / (double)(ns1 - ns0);
+	return frequency;
+}
+
+
+//===========================================================
+//===========================================================
+// Nominal TSC frequency from MSR_PLATFORM_INFO (0xCE) or CPUID 0x16.  0 if neither is there.
+static double freq_nominal(u32 max_leaf, int intel, double near, char *source, int length)
+{
+	unsigned long long platform_info;
+	u32 eax, ebx, ecx, edx;
+	char msrname[100];
+	double ratio;
+
+	if (!intel)
+		return 0;
+
+	// Only poke the MSR if the driver's already loaded (no modprobe, no error spew)
+	msr_name(0, msrname, sizeof(msrname));
+	if ( (access(msrname, R_OK) == 0) && (SHF_rdmsr(0, 0xCE, &platform_info) == 0) )
+		{
+		ratio = (double)((platform_info >> 8) & 0xFF);
+		if (ratio != 0)
+			{
+			snprintf(source, length, "MSR 0xCE");
+			// Nehalem/Westmere use a 133.33MHz bus clock, everything since a 100MHz one
+			if (fabs((ratio * 133333333.0) - near) < fabs((ratio * 100000000.0) - near))
+				return ratio * 133333333.0;
+			return ratio * 100000000.0;
+			}
+		}
+
+	if (max_leaf >= 0x16)
+		{
+		shf_cpuid(0x16, 0, &eax, &ebx, &ecx, &edx);
+		if (eax & 0xFFFF)
+			{
+			snprintf(source, length, "CPUID 0x16");
+			return (double)(eax & 0xFFFF) * 1000000.0;
+			}
+		}
+	return 0;
+}
+
+
+//===========================================================
+//===========================================================
+// Last resort:  the old HPET/TSC loop, but 100ms instead of 5s
+static double freq_hpet(double *error)
+{
+	u64 start_time, end_time, HPET_start_time, HPET_end_time, temp, read_start;
+	double hpet_frequency, frequency;
+	long long give_up;
+
+	if (SHF_HPET_Open(NULL, &hpet_frequency) != 0)
+		return 0;
+
+	// Counter isn't moving:  give up after 0.5s of wall time.  The clock may be why we're
+	// here at all - without it, ~0x1000000000 TSC cycles (tens of seconds) is the backstop.
+	give_up = freq_clock_ns();
+	if (give_up >= 0)
+		give_up = give_up + 500000000LL;
+
+	read_start = rdtsc();
+	HPET_start_time = SHF_HPET_Read();
+	start_time = rdtsc();
+	HPET_end_time = HPET_start_time + (u64)(hpet_frequency / 10);	// 100ms
+	temp = 0;
+	while (temp < HPET_end_time)
+		{
+		temp = SHF_HPET_Read();
+		if ( (give_up >= 0) ? (freq_clock_ns() > give_up) : ((rdtsc() - start_time) > 0x1000000000ULL) )
+			return 0;
+		}
+	end_time = rdtsc();
+
+	frequency = (double)(end_time - start_time) * hpet_frequency / (double)(temp - HPET_start_time);
+
+	// Each end is only known to within one HPET read (an uncached MMIO load), plus a tick
+	*error = frequency * ( ((double)(start_time - read_start) * 2.0 / (double)(end_time - start_time)) +
+		(1.0 / (double)(temp - HPET_start_time)) );
+	return frequency;
+}
+
+
+//===========================================================
+//===========================================================
+// TSC Calibration Cache
+//===========================================================
+// The calibration above only lives as long as the process.  The answer is saved in
+// $XDG_RUNTIME_DIR/samtool_tsc (or /run/samtool_tsc) so the next samtool run gets it for free.
+// Both live in tmpfs, and the file is keyed by the boot ID and CPU signature, so a reboot
+// or moving the disk to another box throws it away.
+#define FREQ_CACHE_NAME		"samtool_tsc"
+#define FREQ_CACHE_VERSION	1
+
+
+//===========================================================
+//===========================================================
+static int freq_cache_path(char *path, int length)
+{
+	char *dir;
+
+	dir = getenv("XDG_RUNTIME_DIR");
+	if ( (dir == NULL) || (dir[0] == 0) )
+		dir = "/run";
+	if (snprintf(path, length, "%s/%s", dir, FREQ_CACHE_NAME) >= length)
+		return -1;
+	return 0;
+}
+
+
+//===========================================================
+//===========================================================
+// "<boot_id> <vendor> <CPUID 1 EAX>".  Returns -1 if there's no boot ID.
+static int freq_cache_key(char *key, int length)
+{
+	u32 eax, ebx, ecx, edx;
+	char boot_id[64], vendor[13];
+	FILE *fp;
+
+	fp = fopen("/proc/sys/kernel/random/boot_id", "r");
+	if (fp == NULL)
+		return -1;
+	if (fgets(boot_id, sizeof(boot_id), fp) == NULL)
+		{
+		fclose(fp);
+		return -1;
+		}
+	fclose(fp);
+	boot_id[strcspn(boot_id, "\r\n")] = 0;
+
+	shf_cpuid(0, 0, &eax, &ebx, &ecx, &edx);
+	memcpy(vendor, &ebx, 4);
+	memcpy(vendor + 4, &edx, 4);
+	memcpy(vendor + 8, &ecx, 4);
+	vendor[12] = 0;
+	shf_cpuid(1, 0, &eax, &ebx, &ecx, &edx);
+
+	snprintf(key, length, "%s %s %08X", boot_id, vendor, eax);
+	return 0;
+}
+
+
+//===========================================================
+//===========================================================
+// Returns 0 and fills in info if there's a cache file for this boot/CPU
+static int freq_cache_load(struct SHF_freq_info *info)
+{
+	char path[256], key[128], line[256], source[32];
+	int version = 0, have_key = 0, have_freq = 0;
+	FILE *fp;
+
+	if ( (freq_cache_path(path, sizeof(path)) != 0) || (freq_cache_key(key, sizeof(key)) != 0) )
+		return -1;
+
+	fp = fopen(path, "r");
+	if (fp == NULL)
+		return -1;
+
+	memset(info, 0, sizeof(*info));
+	while (fgets(line, sizeof(line), fp) != NULL)
+		{
+		line[strcspn(line, "\r\n")] = 0;
+		if (strncmp(line, "version=", 8) == 0)
+			version = atoi(line + 8);
+		else if (strncmp(line, "key=", 4) == 0)
+			have_key = (strcmp(line + 4, key) == 0);
+		else if (strncmp(line, "frequency=", 10) == 0)
+			have_freq = ((info->frequency = strtod(line + 10, NULL)) > 0);
+		else if (strncmp(line, "error=", 6) == 0)
+			info->error = strtod(line + 6, NULL);
+		else if (strncmp(line, "invariant=", 10) == 0)
+			info->invariant = atoi(line + 10);
+		else if (strncmp(line, "source=", 7) == 0)
+			snprintf(info->source, sizeof(info->source), "%.*s", (int)sizeof(info->source) - 1, line + 7);
+		}
+	fclose(fp);
+
+	if ( (version != FREQ_CACHE_VERSION) || (!have_key) || (!have_freq) )
+		return -1;
+
+	snprintf(source, sizeof(source), "%.20s, cached", info->source);
+	snprintf(info->source, sizeof(info->source), "%s", source);
+	return 0;
+}
+
+
+//===========================================================
+//===========================================================
+// Writes the cache file (temp file + rename, so a reader never sees half of it).  Failures are ignored.
+static void freq_cache_save(struct SHF_freq_info *info)
+{
+	char path[256], temp_path[280], key[128];
+	FILE *fp;
+	int fd;
+
+	if ( (freq_cache_path(path, sizeof(path)) != 0) || (freq_cache_key(key, sizeof(key)) != 0) )
+		return;
+
+	snprintf(temp_path, sizeof(temp_path), "%s.%d", path, (int)getpid());
+	fd = open(temp_path, O_WRONLY | O_CREAT | O_TRUNC | O_EXCL, 0644);
+	if (fd == -1)
+		return;
+	fp = fdopen(fd, "w");
+	if (fp == NULL)
+		{
+		close(fd);
+		unlink(temp_path);
+		return;
+		}
+
+	fprintf(fp, "version=%d\n", FREQ_CACHE_VERSION);
+	fprintf(fp, "key=%s\n", key);
+	fprintf(fp, "frequency=%.3f\n", info->frequency);
+	fprintf(fp, "error=%.3f\n", info->error);
+	fprintf(fp, "invariant=%d\n", info->invariant);
+	fprintf(fp, "source=%s\n", info->source);
+
+	if ( (fclose(fp) != 0) || (rename(temp_path, path) != 0) )
+		unlink(temp_path);
+}
+
+
+//===========================================================
+//===========================================================
+void SHF_Freq_Info(struct SHF_freq_info *info)
+{
+	u32 eax, ebx, ecx, edx, max_leaf;
+	char vendor[13];
+	double calibrated, cal_error, nominal;
+	char nominal_source[32];
+	int intel;
+
+	if (freq_info_ready)
+		{
+		if (info != NULL)
+			*info = freq_info;
+		return;
+		}
+
+	// Somebody already did the work this boot?
+	if (freq_cache_load(&freq_info) == 0)
+		{
+		freq_info_ready = 1;
+		if (info != NULL)
+			*info = freq_info;
+		return;
+		}
+
+	memset(&freq_info, 0, sizeof(freq_info));
+
+	shf_cpuid(0, 0, &max_leaf, &ebx, &ecx, &edx);
+	memcpy(vendor, &ebx, 4);
+	memcpy(vendor + 4, &edx, 4);
+	memcpy(vendor + 8, &ecx, 4);
+	vendor[12] = 0;
+	intel = (strcmp(vendor, "GenuineIntel") == 0);
+
+	shf_cpuid(0x80000000, 0, &eax, &ebx, &ecx, &edx);
+	if (eax >= 0x80000007)
+		{
+		shf_cpuid(0x80000007, 0, &eax, &ebx, &ecx, &edx);
+		freq_info.invariant = (edx >> 8) & 1;
+		}
+
+	// 1) CPUID 0x15 with a known crystal:  exact
+	if ( (intel) && (max_leaf >= 0x15) )
+		{
+		shf_cpuid(0x15, 0, &eax, &ebx, &ecx, &edx);
+		if ( (eax != 0) && (ebx != 0) && (ecx != 0) )
+			{
+			freq_info.frequency = (double)ecx * (double)ebx / (double)eax;
+			freq_info.error = 0;
+			snprintf(freq_info.source, sizeof(freq_info.source), "CPUID 0x15");
+			}
+		}
+
+	// 2) Short calibration against the OS clock, confirmed by the nominal frequency if possible
+	if (freq_info.frequency == 0)
+		{
+		calibrated = freq_calibrate(&cal_error);
+		if (calibrated != 0)
+			{
+			nominal = freq_nominal(max_leaf, intel, calibrated, nominal_source, sizeof(nominal_source));
+			if ( (nominal != 0) && (fabs(nominal - calibrated) <= cal_error) )
+				{
+				freq_info.frequency = nominal;
+				freq_info.error = fabs(nominal - calibrated);
+				snprintf(freq_info.source, sizeof(freq_info.source), "%s", nominal_source);
+				}
+			else
+				{
+				freq_info.frequency = calibrated;
+				freq_info.error = cal_error;
+				snprintf(freq_info.source, sizeof(freq_info.source), "CLOCK_MONOTONIC_RAW");
+				}
+			}
+		}
+
+	// 3) HPET
+	if (freq_info.frequency == 0)
+		{
+		freq_info.frequency = freq_hpet(&freq_info.error);
+		snprintf(freq_info.source, sizeof(freq_info.source), "HPET");
+		}
+
+	if (freq_info.frequency == 0)
+		{
+		printf("Couldn't find the TSC frequency (no CPUID 0x15, clock, or HPET).  Pass it with 'f=#.##'\n");
+		snprintf(freq_info.source, sizeof(freq_info.source), "none");
+		}
+	else
+		freq_cache_save(&freq_info);
+
+	freq_info_ready = 1;
+	if (info != NULL)
+		*info = freq_info;
+}
+
+
+//===========================================================
+//===========================================================
+double Freq_Calc()
+// Returns the TSC frequency in Hz.  Only figured out once per run (see SHF_Freq_Info).
+{
+	struct SHF_freq_info info;
+
+	SHF_Freq_Info(&info);
+	return info.frequency;
+}
+
+
+//===========================================================
+//===========================================================
+// HPET Clock
+//===========================================================
+// Read_HPET used to find RCBA through PCI, turn the HPET address decode on, and read the
+// low 32 bits of the counter through two /dev/mem open/mmap/munmap cycles - EVERY sample.
+// Now the HPET is found once (ACPI HPET table, else the PCH's RCBA HPTC register), its
+// registers stay mapped (our own mapping, so the SHFmem_ cache can't evict it), and a read
+// is one load of the 64-bit main counter.
+#define HPET_CAPABILITIES	0x00		// [63:32] = period in femtoseconds, [13] = 64 bit counter
+#define HPET_CONFIG		0x10		// [0] = ENABLE_CNF (counter running)
+#define HPET_COUNTER		0xF0
+
+static volatile u8 *hpet_regs = NULL;
+static u64 hpet_base = 0;
+static u32 hpet_period_fs = 0;
+static int hpet_counter_64 = 0;
+static int hpet_tried = 0;
+
+
+//===========================================================
+//===========================================================
+// HPET ACPI table:  36 byte header, u32 event timer block ID, then the base address as a
+// Generic Address Structure (u8 space, u8 width, u8 offset, u8 access size, u64 address)
+static u64 hpet_from_acpi(void)
+{
+	u8 table[56];
+	u64 address;
+	int fd;
+
+	fd = open("/sys/firmware/acpi/tables/HPET", O_RDONLY);
+	if (fd == -1)
+		return 0;
+	if ( (read(fd, table, sizeof(table)) != sizeof(table)) || (strncmp((char *)table, "HPET", 4) != 0) ||
+		  (table[40] != 0) )		// 0 = system memory space
+		{
+		close(fd);
+		return 0;
+		}
+	close(fd);
+
+	memcpy(&address, &table[44], sizeof(address));
+	return address;
+}
+
+
+//===========================================================
+//===========================================================
+// Pre-ACPI way (ICH/early PCH):  RCBA + 0x3404 = HPTC.  [7] = address enable, [1:0] = which 4K.
+static u64 hpet_from_rcba(void)
+{
+	u32 RCBA_Base;
+	volatile u8 *hptc;
+
+	RCBA_Base = SHFpci_read_dword(0x00, 0x1F, 0x00, 0xF0) & 0xFFFFC000;
+	if ( (RCBA_Base == 0) || (RCBA_Base == 0xFFFFC000) )
+		return 0;
+	hptc = SHFmem_map(RCBA_Base + 0x3404, 1);
+	if (hptc == NULL)
+		return 0;
+
+	// On some boards I needed to enable timer:  [7] = 1b.
+	*hptc = *hptc | 0x80;
+	return 0xFED00000 + ((u64)(*hptc & 0x03) << 12);
+}
+
+
+//===========================================================
+//===========================================================
+int SHF_HPET_Open(u64 *base, double *frequency)
+{
+	u64 capabilities;
+	void *map_base;
+	int fd;
+
+	if ( (!hpet_tried) && (hpet_regs == NULL) )
+		{
+		hpet_tried = 1;
+
+		hpet_base = hpet_from_acpi();
+		if (hpet_base == 0)
+			hpet_base = hpet_from_rcba();
+		if (hpet_base == 0)
+			return -1;
+
+		fd = open("/dev/mem", O_RDWR | O_SYNC);
+		if (fd == -1)
+			return -1;
+		map_base = mmap(0, MAP_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, (off_t)(hpet_base & ~((u64)MAP_MASK)));
+		close(fd);		// Mapping stays after the close
+		if (map_base == MAP_FAILED)
+			return -1;
+		hpet_regs = (volatile u8 *)map_base + (hpet_base & MAP_MASK);
+
+		capabilities = *((volatile u32 *)(hpet_regs + HPET_CAPABILITIES));
+		hpet_period_fs = *((volatile u32 *)(hpet_regs + HPET_CAPABILITIES + 4));
+		hpet_counter_64 = (capabilities >> 13) & 1;
+
+		// Spec says the period is non-zero and <= 100ns.  Anything else isn't an HPET.
+		if ( (hpet_period_fs == 0) || (hpet_period_fs > 100000000) )
+			{
+			munmap(map_base, MAP_SIZE);
+			hpet_regs = NULL;
+			return -1;
+			}
+
+		// Make sure the main counter is running
+		if ( (*((volatile u32 *)(hpet_regs + HPET_CONFIG)) & 0x01) == 0 )
+			*((volatile u32 *)(hpet_regs + HPET_CONFIG)) |= 0x01;
+		}
+
+	if (hpet_regs == NULL)
+		return -1;
+	if (base != NULL)
+		*base = hpet_base;
+	if (frequency != NULL)
+		*frequency = 1000000000000000.0 / (double)hpet_period_fs;
+	return 0;
+}
+
+
+//===========================================================
+//===========================================================
+u64 SHF_HPET_Read(void)
+{
+	static u32 LAST_HPET_Timer_Low = 0x00;
+	static u64 HPET_Timer_Hi = 0x00;
+	volatile u32 *counter;
+	u32 low, high;
+
+	if ( (hpet_regs == NULL) && (SHF_HPET_Open(NULL, NULL) != 0) )
+		return 0;
+	counter = (volatile u32 *)(hpet_regs + HPET_COUNTER);
+
+	if (hpet_counter_64)
+		{
+		if (sizeof(long) == sizeof(u64))
+			return *((volatile u64 *)counter);
+
+		// 32 bit build:  no single 64 bit load, so make sure the high half didn't move
+		do	{
+			high = counter[1];
+			low = counter[0];
+			} while (counter[1] != high);
+		return ((u64)high << 32) | low;
+		}
+
+	// 32 bit counter:  note the roll-overs ourselves
+	low = counter[0];
+	if (low < LAST_HPET_Timer_Low)
+		HPET_Timer_Hi = HPET_Timer_Hi + 1;
+	LAST_HPET_Timer_Low = low;
+	return (HPET_Timer_Hi << 32) | low;
+}
+
+
+//===========================================================
+//===========================================================
+u64 Read_HPET()
+// Kept for old callers.  Same as SHF_HPET_Read.
+{
+	return SHF_HPET_Read();
+}
+
+
+//===========================================================
+//===========================================================
+double tsc_delay(u64 start_time, u64 end_time, char *units, double input_freq)
+{
+	u64 difference = end_time-start_time;
+	double frequency;
+
+	if (input_freq == 0)
+		{
+		frequency = Freq_Calc(); // This will be 3.2 for 3.2 GHz
+		}
+	else
+		frequency = input_freq;
+//	SHFprint(difference, 16, 10,"0x","  ");
+//	printf("Freq:  %f", frequency);
+//	printf("\n");
+
+
+		if (strncmp(units, "clocks", 6) == 0)
+			return difference;
+		if (strncmp(units, "cycles", 6) == 0)
+			return difference;
+
+		if (strncmp(units, "sec", 3) == 0)
+			return difference/frequency;
+
+		if (strncmp(units, "ms", 2) == 0)
+			return (difference*1000)/frequency;
+
+		if (strncmp(units, "us", 4) == 0)
+			return (difference*1000000)/frequency;
+
+		if (strncmp(units, "ns", 2) == 0)
+			return (difference*1000000000)/frequency;
+
+	return -1;
+}
+
+
+//===========================================================
+//===========================================================
+double assembly_delay(u64 passed_address, char *units, u32 *read_result, double input_freq)
+{
+	u64 start_time = 0, end_time = 0;
+	u64 difference;
+
+	unsigned tsc_high, tsc_low;
+
+	int fd; 
+	void *map_base, *virt_addr; 
+	unsigned long writeval = 0;
+	off_t target;
+	int access_type = 'w';
+	static u32 read_data=0;
+
+	static double frequency = 0;
+	// If run a second time during program, just exit with the last read frequency!
+
+	// I hate warnings:
+	passed_address = passed_address;
+	start_time = start_time;
+	end_time = end_time;
+	access_type = access_type;
+	writeval = writeval;
+	read_result = read_result;
+	read_data = read_data;
+
+	// -------------------------------
+	if (input_freq == 0)
+		{
+		frequency = Freq_Calc(); // This will be 3.2 for 3.2 GHz
+		}
+	else
+		frequency = input_freq;
+
+	// -------------------------------
+	target = passed_address;
+
+	if((fd = open("/dev/mem", O_RDWR | O_SYNC)) == -1) FATAL;
+	fflush(stdout);
+    
+	/* Map one page */
+	map_base = mmap(0, MAP_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, target & ~MAP_MASK);
+	if(map_base == (void *) -1) 
+		{
+		printf("Address we tried to pass:\t0x%lX\n", target);
+		close(fd);
+		FATAL;
+		}
+
+	virt_addr = map_base + (target & MAP_MASK);
+
+//  ---------------------------------------------------------
+// The Ugliness
+	//  ---------------------------------------------------------
+	//	Read the TSC for START TIME
+	asm ("LFENCE;");
+   	asm volatile("rdtsc" : "=a" (tsc_low), "=d" (tsc_high) );
+	asm ("LFENCE;");        //I get diff. answers if I move LFENCE's in & out
+	//  ---------------------------------------------------------
+	start_time = ( (unsigned long long)(tsc_low) | ((unsigned long long)(tsc_high) << 32)  );
+
+	read_data = *((unsigned long *) virt_addr);	// DATA READ HERE
+
+	//  ---------------------------------------------------------
+	//	Read the TSC for end TIME
+	asm ("LFENCE;");
+   	asm volatile("rdtsc" : "=a" (tsc_low), "=d" (tsc_high) );
+	asm ("LFENCE;");        //I get diff. answers if I move LFENCE's in & out
+	//  ---------------------------------------------------------
+
+	end_time = ( (unsigned long long)(tsc_low) | ((unsigned long long)(tsc_high) << 32)  );
+//  ---------------------------------------------------------
+
+	close(fd);
+
+	// ------------------------------
+	*read_result = read_data;
+	difference = end_time-start_time;
+
+	if (strncmp(units, "clocks", 6) == 0)
+		return difference;
+	if (strncmp(units, "cycles", 6) == 0)
+		return difference;
+
+	if (strncmp(units, "sec", 3) == 0)
+		return difference/frequency;
+
+	if (strncmp(units, "ms", 2) == 0)
+		return (difference*1000)/frequency;
+
+	if (strncmp(units, "us", 4) == 0)
+		return (difference*1000000)/frequency;
+
+	if (strncmp(units, "ns", 2) == 0)
+		return (difference*1000000000)/frequency;
+
+	return -1;
+}
+
+
+//===========================================================
+//===========================================================
+void neg_add_one(u32 *i)
+{
+	// Ignore this code.  I needed it to test some theories on Ref Passing.
+	// I'll need it again some day....
+	//
+	// Pro-Tip.  Passing "&variable" doesn't work in GCC!!!
+	u32 thedata;
+
+	*i= -*i;
+	thedata = *i+1;
+	*i=thedata;
+	// warnings...*sigh*
+	thedata = thedata;
+}
+
+
+//===========================================================
+//===========================================================
+// Latency Histogram
+//===========================================================
+// assembly_delay/read_assembly_delay time ONE access.  One sample is mostly noise (SMIs,
+// interrupts, the first touch of the page).  SHF_mem_latency repeats the timed access and
+// drops every sample into a log-linear (HdrHistogram style) histogram:  exact below
+// 2^SHF_HIST_SUB_BITS cycles, then each power of 2 split into 2^(SHF_HIST_SUB_BITS-1) buckets,
+// so any percentile is within 1/128 (<0.8%) of the real sample - with no sample array.
+
+//===========================================================
+//===========================================================
+static int hist_index(u64 value)
+{
+	int msb, shift;
+
+	if (value < (1ULL << SHF_HIST_SUB_BITS))
+		return (int)value;
+	msb = 63 - __builtin_clzll(value);
+	shift = msb - SHF_HIST_SUB_BITS + 1;
+	return (shift << (SHF_HIST_SUB_BITS - 1)) + (int)(value >> shift);
+}
+
+
+//===========================================================
+//===========================================================
+// Largest value that lands in bucket index
+static u64 hist_value(int index)
+{
+	int shift;
+	u64 sub;
+
+	if (index < (1 << SHF_HIST_SUB_BITS))
+		return index;
+	shift = (index >> (SHF_HIST_SUB_BITS - 1)) - 1;
+	sub = index - (shift << (SHF_HIST_SUB_BITS - 1));
+	return ((sub + 1) << shift) - 1;
+}
+
+
+//===========================================================
+//===========================================================
+void SHF_hist_init(struct SHF_histogram *hist)
+{
+	memset(hist, 0, sizeof(*hist));
+	hist->min = ~0ULL;
+}
+
+
+//===========================================================
+//===========================================================
+void SHF_hist_record(struct SHF_histogram *hist, u64 value)
+{
+	hist->bucket[hist_index(value)]++;
+	hist->count++;
+	hist->sum = hist->sum + value;
+	if (value < hist->min)
+		hist->min = value;
+	if (value > hist->max)
+		hist->max = value;
+}
 
 
-// MSR Read Routine
 //===========================================================
 //===========================================================
-// Posted by Alexander Weggerle (Intel) Wed, 02/08/2012 - 01:57 
-// http://software.intel.com/en-us/forums/topic/280098
-// NOTE:  YOU MUST RUN sudo modprobe msr before running these commands
-// NOTE:  You MIGHT have to run sudo -s before running these commands
+u64 SHF_hist_percentile(struct SHF_histogram *hist, double percentile)
+{
+	u64 target, seen = 0, value;
+	int i;
 
-int SHF_rdmsr (int CPU_number, unsigned int MsrNum, unsigned long long *MsrVal) {
-        char msrname[100];
-        unsigned char MsrBuffer[8];
-        int fh;
-        off_t offset, fpos;
+	if (hist->count == 0)
+		return 0;
+	target = (u64)ceil((percentile * hist->count / 100.0) - 0.000001);		// 99.9% of 200000 is 199800, not 199800.00000000003
+	if (target < 1)
+		target = 1;
 
-        /* Ok, use the /dev/CPU interface */
-        #ifdef __ANDROID__
-                snprintf (msrname,sizeof(msrname), "/dev/msr%d", CPU_number);
-        #else
-                snprintf (msrname,sizeof(msrname), "/dev/cpu/%d/msr", CPU_number);
-        #endif
+	for (i=0; i<SHF_HIST_BUCKETS; i++)
+		{
+		seen = seen + hist->bucket[i];
+		if (seen >= target)
+			break;
+		}
+	value = hist_value(i);
+	if (value > hist->max)
+		value = hist->max;				// Top bucket's wider than what we actually saw
+	if (value < hist->min)
+		value = hist->min;
+	return value;
+}
 
-        fh = open (msrname, O_RDONLY);
-        if (fh != -1) {
-                offset = (off_t)MsrNum;
-                fpos = lseek (fh, offset, SEEK_SET);
-                if(fpos != offset) {
-                        printf("seek %s to offset= 0x%x failed at %s %d\n",
-                        msrname, MsrNum, __FILE__, __LINE__);
-                        return -1;
-                }
-                read (fh, MsrBuffer, sizeof(MsrBuffer));
-                if (MsrVal!=0) *MsrVal = (*(unsigned long long *)MsrBuffer);
-                close (fh);
-                return 0;
-        } else {
-                /* Something went wrong, just get out. */
-                printf("Open of msr dev= '%s' failed at %s %d\n", msrname, __FILE__, __LINE__);
-                printf("You may need to do (as root) 'sudo modprobe msr'\n");
-                return -1;
-        }
+
+//===========================================================
+//===========================================================
+// LFENCE on both sides so the access can't drift across the timestamp (same as assembly_delay)
+static inline u64 latency_tsc(void)
+{
+	u32 tsc_low, tsc_high;
+
+	asm volatile ("LFENCE;" "rdtsc;" "LFENCE;" : "=a" (tsc_low), "=d" (tsc_high) : : "memory");
+	return ((u64)tsc_high << 32) | tsc_low;
 }
 
 
-// MSR Write Commadn (DOES NOT APPEAR TO WORK CORRECTLY)
 //===========================================================
 //===========================================================
-// This write MSR command does not seem to be working
-// Looks very much like protection issue of some type (writes to MSR's not allowed)
-// These write to MSR's are NOT working.  Instead, I'm calling:  		system(tempstr);	 where tempstr is the wrmsr 0xc3 0x11
-int SHF_wrmsr (int CPU_number, unsigned int MsrNum, unsigned long long *MsrVal) {
-        char msrname[100];
-        unsigned char MsrBuffer[8];
-        int fh;
-        off_t offset, fpos;
+int SHF_mem_latency(u64 address, int size, int write, u64 data, u64 repeat, u64 warmup,
+						  struct SHF_histogram *hist, u64 *overhead, u64 *last_read)
+{
+	volatile void *virt_addr;
+	u64 start, end, i, value = 0, best = ~0ULL;
 
-        /* Ok, use the /dev/CPU interface */
-        #ifdef __ANDROID__
-                snprintf (msrname,sizeof(msrname), "/dev/msr%d", CPU_number);
-        #else
-                snprintf (msrname,sizeof(msrname), "/dev/cpu/%d/msr", CPU_number);
-        #endif
+	virt_addr = SHFmem_map(address, size);
+	if (virt_addr == NULL)
+		{
+		printf("Address we tried to pass:\t0x%llX\n", (unsigned long long)address);
+		return -1;
+		}
 
-        fh = open (msrname, O_RDWR | O_SYNC);
-		fflush(stdout);
+	// What an empty start/end pair costs.  Reported, not subtracted
+	for (i=0; i<1000; i++)
+		{
+		start = latency_tsc();
+		end = latency_tsc();
+		if ((end - start) < best)
+			best = end - start;
+		}
+	*overhead = best;
 
-        if (fh != -1) {
-                offset = (off_t)MsrNum;
-                fpos = lseek (fh, offset, SEEK_SET);
-                if(fpos != offset) {
-                        printf("seek %s to offset= 0x%x failed at %s %d\n",
-                        msrname, MsrNum, __FILE__, __LINE__);
-                        return -1;
-                }
-                read (fh, MsrBuffer, sizeof(MsrBuffer));
-                if (MsrVal!=0) 
-					{
-//					printf("*MsrVal: %llx\n", *MsrVal);  
-					(*(unsigned long long *)MsrBuffer) = *MsrVal;
+	SHF_hist_init(hist);
+	for (i=0; i<(warmup + repeat); i++)
+		{
+		start = latency_tsc();
+		if (write)
+			{
+			switch (size)
+				{
+				case 1:	*(volatile u8 *)virt_addr = data;		break;
+				case 2:	*(volatile u16 *)virt_addr = data;		break;
+				case 4:	*(volatile u32 *)virt_addr = data;		break;
+				default:	*(volatile u64 *)virt_addr = data;		break;
+				}
+			asm volatile ("SFENCE;" : : : "memory");			// Same as the timed write routines
+			}
+		else
+			{
+			switch (size)
+				{
+				case 1:	value = *(volatile u8 *)virt_addr;		break;
+				case 2:	value = *(volatile u16 *)virt_addr;		break;
+				case 4:	value = *(volatile u32 *)virt_addr;		break;
+				default:	value = *(volatile u64 *)virt_addr;		break;
+				}
+			}
+		end = latency_tsc();
+
+		if (i >= warmup)
+			SHF_hist_record(hist, end - start);
+		}
 
-//					printf("\nLet's Read it Back:  "); 
-//					printf("%llx\n", (*(unsigned long long *)MsrBuffer));
-					// Sam, this proves that the WRITES are "working", just not permanent.
-					}
+	*last_read = value;
+	return 0;
+}
 
-				fflush(stdout);
-                close (fh);
-                return 0;
-        } else {
-                /* Something went wrong, just get out. */
-                printf("Open of msr dev= '%s' failed at %s %d\n", msrname, __FILE__, __LINE__);
-                printf("You may need to do (as root) 'sudo modprobe msr'\n");
-                return -1;
-        }
+
+//===========================================================
+//===========================================================
+// Pointer Chase
+//===========================================================
+// The timed transfer routines stream, so the prefetchers and the memory controller hide the
+// latency.  Here every load's address comes out of the load before it (p = *p), so each one
+// pays the whole trip:  L1, L2, LLC, DRAM, or the device behind a BAR, depending on how big
+// the working set is.  Elements are stride bytes apart; the chain either walks them in order
+// (prefetch friendly) or in one random cycle through all of them (Sattolo's shuffle - no
+// short loops, every element visited once per lap).
+static void * volatile chase_sink;
+
+
+//===========================================================
+//===========================================================
+double SHF_chase(volatile u8 *base, u64 working_set, u64 stride, int random, u64 loads)
+{
+	void * volatile *p;
+	u32 *order;
+	u64 count, i, j, seed = 0x9E3779B97F4A7C15ULL, start, end;
+	u32 t;
+
+	count = working_set / stride;
+	if ( (count < 2) || (count > 0xFFFFFFFFULL) || (stride < sizeof(void *)) || (stride % sizeof(void *)) )
+		return -1;
+	order = malloc(count * sizeof(u32));
+	if (order == NULL)
+		return -1;
+
+	for (i=0; i<count; i++)
+		order[i] = i;
+	if (random)
+		{
+		for (i=count-1; i>0; i--)						// Sattolo:  j < i, so it's ONE cycle
+			{
+			seed ^= seed << 13;
+			seed ^= seed >> 7;
+			seed ^= seed << 17;
+			j = seed % i;
+			t = order[i];
+			order[i] = order[j];
+			order[j] = t;
+			}
+		}
+	for (i=0; i<count; i++)
+		*(void * volatile *)(base + ((u64)order[i] * stride)) = (void *)(base + ((u64)order[(i + 1) % count] * stride));
+	p = (void * volatile *)(base + ((u64)order[0] * stride));
+	free(order);
+
+	if (loads == 0)
+		loads = (count * 4 < 0x100000) ? 0x100000 : (count * 4 > 0x1000000) ? 0x1000000 : count * 4;
+	loads = (loads + 7) & ~7ULL;
+
+	// One lap (or 4M loads) to pull in what fits in the caches, then the timed run
+	for (i=0; (i < count) && (i < 0x400000); i++)
+		p = *p;
+
+	start = latency_tsc();
+	for (i=0; i<loads; i+=8)
+		{
+		p = *p;	p = *p;	p = *p;	p = *p;
+		p = *p;	p = *p;	p = *p;	p = *p;
+		}
+	end = latency_tsc();
+
+	chase_sink = (void *)p;									// So the chain is live
+	return (double)(end - start) / loads;
 }
 
+
 //===========================================================
 //===========================================================
-void SHFprint(u64 number, int min_length, int base, char *before, char *after)
-// number - the input passed number
-// min_length = how many chars minimum you want to display.
-//		For example, number = 0x323.  min_length = 4.  Output = 0x0323
-//		base.  You want hexidecimal (16)?  Base 10 (10)?  Octal (8)?
+// Transfer Buffer Arena
+//===========================================================
+// samtool used to malloc 1GB for every command (even "io 0x80"), and the timed routines then
+// took a page fault on every new 4K of it, in the middle of the measurement.  Now the buffer
+// is sized for the command, mmap'd (2MB pages when it's big enough, explicit hugetlb if any
+// are reserved, else transparent hugepages), optionally pre-faulted, and kept for the next
+// command.  It only gets remapped when a bigger one is needed.
+#define ARENA_HUGE	0x200000ULL		// 2MB
+
+static u8 *arena_base = NULL;
+static u64 arena_size = 0;
+static int arena_populated = 0;
+static int arena_hugetlb = 0;			// MAP_HUGETLB pages:  can only be dropped 2MB at a time
+
+
+//===========================================================
+//===========================================================
+u8 *SHF_buffer(u64 bytes, int populate)
 {
-	u64 divisor;
-	u64 digit;
-	int i;
+	void *base = MAP_FAILED;
+	u64 size, i;
 
-// I hate warnings
-	number = number;     
-	min_length = min_length;     
-	base = base;
+	size = (bytes >= ARENA_HUGE) ? ((bytes + ARENA_HUGE - 1) & ~(ARENA_HUGE - 1)) : ((bytes + MAP_MASK) & ~MAP_MASK);
+	if (size == 0)
+		size = MAP_SIZE;
 
-	printf("%s", before);
+	// Not populated (cold, or not timed) = ordinary pages, so cold can drop them 4K at a time
+	if ( (arena_base == NULL) || (size > arena_size) || ((!populate) && (arena_hugetlb)) )
+		{
+		SHF_buffer_release();
 
-	for (i=(min_length-1); i>=0 ;i--)
+		if ( (size >= ARENA_HUGE) && (populate) )
+			base = mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (populate ? MAP_POPULATE : 0), -1, 0);
+		if (base == MAP_FAILED)
+			{
+			base = mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (base == MAP_FAILED)
+				return NULL;
+			if (size >= ARENA_HUGE)
+				madvise(base, size, MADV_HUGEPAGE);	// Before anything touches it
+			}
+		else
+			{
+			arena_populated = populate;
+			arena_hugetlb = 1;
+			}
+
+		arena_base = base;
+		arena_size = size;
+		}
+
+	// Fault it all in now, not during a timed transfer
+	if ( (populate) && (!arena_populated) )
 		{
-		divisor = pow(base,i);
-		digit = (number/divisor);
-		number = number-(digit*divisor);
-		printf("%X", (unsigned int)digit);
+		for (i=0; i<arena_size; i+=MAP_SIZE)
+			((volatile u8 *)arena_base)[i] = 0;
+		arena_populated = 1;
 		}
+	return arena_base;
+}
 
-	printf("%s", after);
+
+//===========================================================
+//===========================================================
+void SHF_buffer_release(void)
+{
+	if (arena_base != NULL)
+		munmap(arena_base, arena_size);
+	arena_base = NULL;
+	arena_size = 0;
+	arena_populated = 0;
+	arena_hugetlb = 0;
+}
 
 
-	return;
+//===========================================================
+//===========================================================
+// Timed Transfer Pages
+//===========================================================
+// The timed routines used to start the clock with the buffer pages they were about to touch
+// still unfaulted, so every first touch was timed along with the transfer.  Only the buffer
+// side has anything to fault:  /dev/mem's mmap is remap_pfn_range (VM_IO | VM_PFNMAP), so its
+// page tables are all built by mmap itself - MAP_POPULATE and mlock don't do anything there.
+// Now, unless cold is set, every buffer page is touched before the start timestamp, and
+// lock = mlock the buffer so none of it can be paged out in between.  cold = the old way, on
+// purpose:  a read's buffer pages are thrown away (MADV_DONTNEED) so every one faults again
+// inside the timed window.  A cold command's arena isn't hugetlb (see SHF_buffer), but if
+// one is handed in anyway only whole 2MB pages can go.  If the kernel won't drop them (or
+// there's no whole page in the range) the name says so.  cold wins over lock (mlock faults
+// everything in).
+static int timed_cold = 0;
+static int timed_lock = 0;
+static int timed_lock_failed = 0;
+static int timed_drop_failed = 0;
+
+
+//===========================================================
+//===========================================================
+void SHF_timed_pages(int cold, int lock)
+{
+	timed_cold = cold;
+	timed_lock = lock;
+	timed_lock_failed = 0;
+	timed_drop_failed = 0;
 }
 
 
 //===========================================================
 //===========================================================
-u64 rdtsc(void)
+char *SHF_timed_pages_name(void)
 {
-	static u64 last;
-	u32 lo, hi;
-	u64 tsc;
+	if ( (timed_cold) && (timed_drop_failed) )
+		return "cold (buffer pages NOT dropped - hugetlb?)";
+	if (timed_cold)
+		return (timed_lock) ? "cold (faults timed, lock ignored)" : "cold (faults timed)";
+	if (timed_lock)
+		return (timed_lock_failed) ? "prefaulted buffer (mlock FAILED - ulimit -l?)" : "prefaulted buffer, mlocked";
+	return "prefaulted buffer";
+}
 
-	last = last;
 
-	if (sizeof(long) == sizeof(u64)) 
+//===========================================================
+//===========================================================
+// Device side of a timed transfer:  exactly the pages it touches, through the SHFmem_map
+// cache - a shell/script hitting the same range again doesn't open or mmap anything, and
+// nothing's unmapped after.  Nothing to prefault or lock (the PFN mapping is complete when
+// mmap returns).  Dies, like it always has, if it can't be mapped.
+static volatile u8 *timed_map(u64 address, u64 bytes, char *caller)
+{
+	return SHFmem_map_or_die(address, bytes, caller);
+}
+
+
+//===========================================================
+//===========================================================
+// Gets the buffer side ready.  write = buffer is the source (holds the pattern - keep it).
+static void timed_buffer(u8 *buffer, u64 bytes, int write)
+{
+	u64 page, first, last, i;
+
+	page = MAP_SIZE;
+	if ( (arena_hugetlb) && (buffer >= arena_base) && (buffer < arena_base + arena_size) )
+		page = ARENA_HUGE;
+	first = ((u64)buffer + page - 1) & ~(page - 1);
+	last = ((u64)buffer + bytes) & ~(page - 1);
+	if ( (timed_cold) && (!write) && (bytes) )
 		{
-	   	asm volatile("rdtsc" : "=a" (lo), "=d" (hi));
-		return ((u64)(hi) << 32) | lo;
+		if ( (last <= first) || (madvise((void *)first, last - first, MADV_DONTNEED) != 0) )		// Whole pages only
+			timed_drop_failed = 1;
 		}
-	else 
+	else if (!timed_cold)
 		{
-	   	asm volatile("rdtsc" : "=A" (tsc));
-		return tsc;
+		for (i=0; i<bytes; i+=MAP_SIZE)
+			((volatile u8 *)buffer)[i] = ((volatile u8 *)buffer)[i];	// Write fault, not just the zero page
+		if (bytes)
+			((volatile u8 *)buffer)[bytes - 1] = ((volatile u8 *)buffer)[bytes - 1];
 		}
+	if ( (timed_lock) && (!timed_cold) && (bytes) && (mlock(buffer, bytes) != 0) )
+		timed_lock_failed = 1;
 }
 
 
 //===========================================================
 //===========================================================
-double Freq_Calc()
-// From Todd Silver ITP Script
-// Tested and works.  Note.  Does not handle HPET roll-over cause I'm in a hurry.  Deal with it.
+// After the transfer:  lets go of the buffer lock.  The device mapping stays in the cache.
+static void timed_done(u8 *buffer, u64 bytes)
 {
-	u64 start_time, end_time;
-	unsigned long HPET_start_time, HPET_end_time, temp; 
+	if ( (timed_lock) && (!timed_cold) && (bytes) )
+		munlock(buffer, bytes);
+}
 
-	static double frequency = 0;
-	// If run a second time during program, just exit with the last read frequency!
 
-	if (frequency == 0)
+//===========================================================
+//===========================================================
+// Fence Policy
+//===========================================================
+// Every transfer routine used to hard-code its fences (MFENCE at the end of every rep movs,
+// and per 4K - plus six more up front - in the XMM blocks).  Now it's a setting, in 64 byte
+// lines between fences:  1 = every line, N = every N lines, 64 = every 4K, 0 = only at the end.
+// Unless someone picks one, each keeps what it had:  rep movs (b/w/d) only fences at the end
+// (fencing a d read every 4K would change the numbers people compare against), the x/xb
+// blocks every 4K.  Reads fence with MFENCE.  Writes are non-temporal/string stores, so SFENCE is enough.
+static u64 block_fence_lines = 64;				// x/xb blocks
+static u64 string_fence_lines = 0;				// rep movsb/w/l (b/w/d)
+
+
+//===========================================================
+//===========================================================
+void SHF_block_fence(u64 lines)
+{
+	if (lines == SHF_FENCE_DEFAULT)
 		{
-		HPET_start_time = Read_HPET();
-		HPET_end_time = HPET_start_time + 0x44463F3; // 5 seconds
-		start_time = rdtsc();
-		temp=0x0;
-		while (temp < HPET_end_time)     // Todd's way of waiting 5 seconds
-			{
-			temp = Read_HPET();
-			}   
-		end_time = rdtsc();
-		frequency = (end_time - start_time)/5;
+		block_fence_lines = 64;
+		string_fence_lines = 0;
+		}
+	else
+		{
+		block_fence_lines = lines;
+		string_fence_lines = lines;
 		}
-	return frequency;
 }
 
 
 //===========================================================
 //===========================================================
-u64 Read_HPET()
-// Note:  This is a 64 bit register, but I can't get my 64 bit Memory Read 
-// Routine to work correctly.  Attempted fix onRoll-over seems to work
+u64 SHF_block_fence_lines(int strings)
 {
-	u32 RCBA_Base,  HPET_Base;
-	u8 u8ReturnData = 0x00;
+	return (strings) ? string_fence_lines : block_fence_lines;
+}
 
-	u64 HPET_Timer_Low = 0x00;
-	static u32 LAST_HPET_Timer_Low = 0x00;
-	static u64 HPET_Timer_Hi = 0x00;
 
-	u64 HPET_Timer_Final;
+//===========================================================
+//===========================================================
+static void block_fence(int write)
+{
+	if (write)
+		asm volatile("SFENCE;" : : : "memory");
+	else
+		asm volatile("MFENCE;" : : : "memory");
+}
 
-	RCBA_Base = SHFpci_read_dword(0x00, 0x1F, 0x00, 0xF0);
-	u8ReturnData = SHFmem_read_byte(RCBA_Base + 0x3404);
 
-	// On some boards I needed to enable timer:  [7] = 1b.
-	SHFmem_write_byte(((RCBA_Base + 0x3404) & (0xFFFFFFFC)), (u8ReturnData | 0x80));
+//===========================================================
+//===========================================================
+// rep movsb/w/l of count elements, fenced per the fence policy
+static void string_transfer(int write, volatile void *src, volatile void *dst, u64 count, u8 size)
+{
+	u64 chunk, step;
 
-/*
-	// TEST CODE:
-	u64 addressx;
-	u64 datax;
-	addressx = (u64)((RCBA_Base + 0x3404) & (0xFFFFFFFC));
-	datax = (u64)(u8ReturnData | 0x80);
-	printf("RCBA_Base:\t0x%X\n", RCBA_Base);
-	printf("Address:\t0x%lX\n", addressx);
-	printf("Data:\t0x%lX\n", datax);
-*/	
-
-	u8ReturnData = u8ReturnData & 0x03;
-	switch (u8ReturnData)
-		{
-		case 0x00:
-			HPET_Base = 0xFED00000;			
-			break;
-		case 0x01:
-			HPET_Base = 0xFED01000;			
-			break;
-		case 0x02:
-			HPET_Base = 0xFED02000;			
-			break;
-		case 0x03:
-			HPET_Base = 0xFED03000;			
-			break;
-		default:
-			HPET_Base = 0xFED00000;			
-		}
-	HPET_Timer_Low = SHFmem_read_dword (HPET_Base + 0xF0);
+	step = (string_fence_lines == 0) ? count : (string_fence_lines * 64) / size;
+	if (step == 0)
+		step = 1;
 
-	// Trying to fix the overflow problem by being clever - Note that 
-	// Generally HPET is going to be read to MEASURE stuff.  Can fix
-	// by noting overflow.
-	if (HPET_Timer_Low < LAST_HPET_Timer_Low)	// Overflow
+	while (count)
 		{
-		HPET_Timer_Hi = HPET_Timer_Hi + 1;
+		chunk = (count < step) ? count : step;
+		count = count - chunk;
+		if (size == 1)
+			asm volatile("cld; rep movsb;" : "+S" (src), "+D" (dst), "+c" (chunk) : : "memory", "cc");
+		else if (size == 2)
+			asm volatile("cld; rep movsw;" : "+S" (src), "+D" (dst), "+c" (chunk) : : "memory", "cc");
+		else
+			asm volatile("cld; rep movsl;" : "+S" (src), "+D" (dst), "+c" (chunk) : : "memory", "cc");
+		block_fence(write);
 		}
-	LAST_HPET_Timer_Low = HPET_Timer_Low;
-
-	HPET_Timer_Final = (HPET_Timer_Hi << 32) + HPET_Timer_Low;
-
-	return HPET_Timer_Final;
 }
 
 
 //===========================================================
 //===========================================================
-double tsc_delay(u64 start_time, u64 end_time, char *units, double input_freq)
+double read_assembly_delay(u64 passed_address, char *units, double input_freq, u64 byte_length, u8 array1[], u8 size)
 {
-	u64 difference = end_time-start_time;
-	double frequency;
+//	u64 start_time = 0, end_time = 0;
+	unsigned tsc_high, tsc_low;
+	unsigned long long int start_time = 0, end_time = 0;
+	u64 difference;
+	volatile void *virt_addr; 
+	unsigned long writeval = 0;
+	off_t target;
+	int access_type = 'w';
+	static u32 read_data=0;
+	static double frequency = 0;
+	// If run a second time during program, just exit with the last read frequency!
+
+	// I hate warnings:
+	passed_address = passed_address;
+	start_time = start_time;
+	end_time = end_time;
+	access_type = access_type;
+	writeval = writeval;
+	read_data = read_data;
+
+/*
+	// -------------------------------
+	if (input_freq == 0.0)		
+		{
+		frequency = Freq_Calc(); // This will be 3.2 for 3.2 GHz
+		}
+	else
+		frequency = input_freq;
+	// -------------------------------
+*/
+	frequency = input_freq;
+	target = passed_address;
+
+	fflush(stdout);
+
+// #define MAP_SIZE 4096UL
+// #define MAP_MASK (MAP_SIZE - 1) 
+
+//	SHFprint(map_size, 8, 0x10, "map_size ", "\n");
+//	SHFprint(map_mask, 8, 0x10, "map_size ", "\n");
+//  	exit(0);
+
+/*  This did not work
+	map_size = ((byte_length + 0xF) & 0xFFFFFFF0);     // 16 byte aligning
+   map_mask = map_size-1;
+*/
+    
+	// -------------------------------
+	/* Map one page */
+//	map_base = mmap(0, MAP_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, target & ~MAP_MASK);
+	u64 count = byte_length/size;			// size =1(byte) / 2(word) / 4(dword) =
+	if (byte_length%size)
+		count = count +1;	
+
+	// Exactly the pages it touches (was the length rounded to 4K and masked off the address - wrong page
+	// whenever the address wasn't aligned to that)
+	virt_addr = timed_map(target, count * size, "read_assembly_delay");
+	// -------------------------------
+
+	timed_buffer(array1, count * size, 0);		// Buffer pages faulted in (or dropped, if cold) before the clock starts
+
+	//  ---------------------------------------------------------
+	//	Read the TSC for START TIME
+	asm ("LFENCE;");
+   	asm volatile("rdtsc" : "=a" (tsc_low), "=d" (tsc_high) );
+	asm ("LFENCE;");        //I get diff. answers if I move LFENCE's in & out
+	//  ---------------------------------------------------------
+
+	start_time = ( (unsigned long long)(tsc_low) | ((unsigned long long)(tsc_high) << 32)  );
+
 
-	if (input_freq == 0)
-		{
-		frequency = Freq_Calc(); // This will be 3.2 for 3.2 GHz
-		}
-	else
-		frequency = input_freq;
-//	SHFprint(difference, 16, 10,"0x","  ");
-//	printf("Freq:  %f", frequency);
-//	printf("\n");
+	//  ---------------------------------------------------------
+	//	DATA READ GOES HERE 
+	// Each "Block" of this is 4K (0-0x1000)
 
+	string_transfer(0, virt_addr, array1, count, size);
 
-		if (strncmp(units, "clocks", 6) == 0)
-			return difference;
-		if (strncmp(units, "cycles", 6) == 0)
-			return difference;
+	//  ---------------------------------------------------------
+	//	Read the TSC for end TIME
+	asm ("LFENCE;");
+   	asm volatile("rdtsc" : "=a" (tsc_low), "=d" (tsc_high) );
+	asm ("LFENCE;");        //I get diff. answers if I move LFENCE's in & out
+	//  ---------------------------------------------------------
 
-		if (strncmp(units, "sec", 3) == 0)
-			return difference/frequency;
+	end_time = ( (unsigned long long)(tsc_low) | ((unsigned long long)(tsc_high) << 32)  );
 
-		if (strncmp(units, "ms", 2) == 0)
-			return (difference*1000)/frequency;
+	//  ---------------------------------------------------------
+	fflush(stdout);
+	timed_done(array1, count * size);
+	//  ---------------------------------------------------------
 
-		if (strncmp(units, "us", 4) == 0)
-			return (difference*1000000)/frequency;
+	//  ---------------------------------------------------------
+	difference = end_time-start_time;
 
-		if (strncmp(units, "ns", 2) == 0)
-			return (difference*1000000000)/frequency;
+//		Debug
+//   printf("start_time:\t\t%llx\n",start_time);
+//   printf("end_time:\t\t%llx\n",end_time);
 
+	if (strncmp(units, "clocks", 6) == 0)
+		return difference;
+	if (strncmp(units, "cycles", 6) == 0)
+		return difference;
+	if (strncmp(units, "sec", 3) == 0)
+		return difference/frequency;
+	if (strncmp(units, "ms", 2) == 0)
+		return (difference*1000)/frequency;
+	if (strncmp(units, "us", 4) == 0)
+		return (difference*1000000)/frequency;
+	if (strncmp(units, "ns", 2) == 0)
+		return (difference*1000000000)/frequency;
 	return -1;
 }
 
 
 //===========================================================
 //===========================================================
-double assembly_delay(u64 passed_address, char *units, u32 *read_result, double input_freq)
+double write_assembly_delay(u64 passed_address, char *units, double input_freq, u64 byte_length, u8 array1[], u8 size)
 {
+	unsigned tsc_high, tsc_low;
 	u64 start_time = 0, end_time = 0;
 	u64 difference;
-
-	unsigned tsc_high, tsc_low;
-
-	int fd; 
-	void *map_base, *virt_addr; 
+	volatile void *virt_addr; 
 	unsigned long writeval = 0;
 	off_t target;
 	int access_type = 'w';
 	static u32 read_data=0;
-
 	static double frequency = 0;
 	// If run a second time during program, just exit with the last read frequency!
 
@@ -847,44 +2664,53 @@ double assembly_delay(u64 passed_address, char *units, u32 *read_result, double
 	end_time = end_time;
 	access_type = access_type;
 	writeval = writeval;
-	read_result = read_result;
 	read_data = read_data;
 
+/*
 	// -------------------------------
-	if (input_freq == 0)
+	if (input_freq == 0.0)		
 		{
 		frequency = Freq_Calc(); // This will be 3.2 for 3.2 GHz
 		}
 	else
 		frequency = input_freq;
-
 	// -------------------------------
+*/
+	frequency = input_freq;
 	target = passed_address;
 
-	if((fd = open("/dev/mem", O_RDWR | O_SYNC)) == -1) FATAL;
 	fflush(stdout);
-    
+
+	// -------------------------------
 	/* Map one page */
-	map_base = mmap(0, MAP_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, target & ~MAP_MASK);
-	if(map_base == (void *) -1) 
-		{
-		printf("Address we tried to pass:\t0x%lX\n", target);
-		FATAL;
-		}
+//	map_base = mmap(0, MAP_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, target & ~MAP_MASK);
+	u64 count = byte_length/size;			// size =1(byte) / 2(word) / 4(dword) =
+	if (byte_length%size)
+		count = count +1;	
 
-	virt_addr = map_base + (target & MAP_MASK);
+	// Exactly the pages it touches (was the length rounded to 4K and masked off the address - wrong page
+	// whenever the address wasn't aligned to that)
+	virt_addr = timed_map(target, count * size, "write_assembly_delay");
+	// -------------------------------
+
+	timed_buffer(array1, count * size, 1);		// Buffer pages faulted in (or dropped, if cold) before the clock starts
 
-//  ---------------------------------------------------------
-// The Ugliness
 	//  ---------------------------------------------------------
 	//	Read the TSC for START TIME
 	asm ("LFENCE;");
    	asm volatile("rdtsc" : "=a" (tsc_low), "=d" (tsc_high) );
 	asm ("LFENCE;");        //I get diff. answers if I move LFENCE's in & out
 	//  ---------------------------------------------------------
+
 	start_time = ( (unsigned long long)(tsc_low) | ((unsigned long long)(tsc_high) << 32)  );
 
-	read_data = *((unsigned long *) virt_addr);	// DATA READ HERE
+
+
+	//  ---------------------------------------------------------
+	//	DATA READ GOES HERE 
+	// Each "Block" of this is 4K (0-0x1000)
+
+	string_transfer(1, array1, virt_addr, count, size);
 
 	//  ---------------------------------------------------------
 	//	Read the TSC for end TIME
@@ -894,126 +2720,317 @@ double assembly_delay(u64 passed_address, char *units, u32 *read_result, double
 	//  ---------------------------------------------------------
 
 	end_time = ( (unsigned long long)(tsc_low) | ((unsigned long long)(tsc_high) << 32)  );
-//  ---------------------------------------------------------
 
-	close(fd);
+	//  ---------------------------------------------------------
+	fflush(stdout);
+	timed_done(array1, count * size);
+	//  ---------------------------------------------------------
 
-	// ------------------------------
-	*read_result = read_data;
+	//  ---------------------------------------------------------
 	difference = end_time-start_time;
 
 	if (strncmp(units, "clocks", 6) == 0)
 		return difference;
 	if (strncmp(units, "cycles", 6) == 0)
 		return difference;
-
 	if (strncmp(units, "sec", 3) == 0)
 		return difference/frequency;
-
 	if (strncmp(units, "ms", 2) == 0)
 		return (difference*1000)/frequency;
-
 	if (strncmp(units, "us", 4) == 0)
 		return (difference*1000000)/frequency;
-
 	if (strncmp(units, "ns", 2) == 0)
 		return (difference*1000000000)/frequency;
-
 	return -1;
 }
 
+//===========================================================
+//===========================================================
+// Block Transfer Kernels
+//===========================================================
+// The XMM block routines used to #include code_block_read.h:  4K worth of hand-unrolled
+// MOVNTDQA/MOVDQA xmm0-3, with an MFENCE after each of the first six 64 byte lines and one
+// after every 4K block.  That can only ever show you the SSE ceiling.  Now there's one small
+// loop per vector width (plus rep movsq), picked with CPUID the first time it's needed:
+//	SHF_KERNEL_AVX512	64 bytes / load  (VMOVNTDQA zmm)
+//	SHF_KERNEL_AVX2		32 bytes / load  (VMOVNTDQA ymm)
+//	SHF_KERNEL_SSE		16 bytes / load  (MOVNTDQA xmm - what code_block_read.h did)
+//	SHF_KERNEL_MOVSQ	 8 bytes / load  (rep movsq)
+// The MMIO side always uses aligned non-temporal loads/stores, the buffer side unaligned ones.
+// Each call moves 64 byte lines, block_transfer does the head/tail and the fencing (see Fence Policy).
+static int block_kernel_forced = SHF_KERNEL_AUTO;
+static int block_kernel_last = SHF_KERNEL_AUTO;
+
 
 //===========================================================
 //===========================================================
-void neg_add_one(u32 *i)
+int SHF_block_kernel_best(void)
 {
-	// Ignore this code.  I needed it to test some theories on Ref Passing.
-	// I'll need it again some day....
-	//
-	// Pro-Tip.  Passing "&variable" doesn't work in GCC!!!
-	u32 thedata;
+	static int best = SHF_KERNEL_AUTO;
+	u32 eax, ebx, ecx, edx, max_leaf, xcr0_lo, xcr0_hi;
+	int avx_os = 0, avx512_os = 0;
 
-	*i= -*i;
-	thedata = *i+1;
-	*i=thedata;
-	// warnings...*sigh*
-	thedata = thedata;
+	if (best != SHF_KERNEL_AUTO)
+		return best;
+
+	best = SHF_KERNEL_MOVSQ;
+	shf_cpuid(0, 0, &max_leaf, &ebx, &ecx, &edx);
+	shf_cpuid(1, 0, &eax, &ebx, &ecx, &edx);
+	if (ecx & (1 << 19))		// SSE4.1 (MOVNTDQA)
+		best = SHF_KERNEL_SSE;
+
+	// The OS has to be saving the wide registers (XGETBV) or the CPUID bits don't mean anything
+	if ( (ecx & (1 << 27)) && (ecx & (1 << 28)) )		// OSXSAVE, AVX
+		{
+		asm volatile("XGETBV;" : "=a" (xcr0_lo), "=d" (xcr0_hi) : "c" (0));
+		avx_os = ((xcr0_lo & 0x06) == 0x06);			// XMM, YMM
+		avx512_os = ((xcr0_lo & 0xE6) == 0xE6);		// + opmask, ZMM 0-15, ZMM 16-31
+		}
+
+	if ( (max_leaf >= 7) && (avx_os) )
+		{
+		shf_cpuid(7, 0, &eax, &ebx, &ecx, &edx);
+		if (ebx & (1 << 5))		// AVX2 (256 bit VMOVNTDQA)
+			best = SHF_KERNEL_AVX2;
+		if ( (avx512_os) && (ebx & (1 << 16)) )		// AVX512F
+			best = SHF_KERNEL_AVX512;
+		}
+	return best;
 }
 
 
 //===========================================================
 //===========================================================
-double read_assembly_delay(u64 passed_address, char *units, double input_freq, u64 byte_length, u8 array1[], u8 size)
+int SHF_block_kernel_select(int kernel)
 {
-//	u64 start_time = 0, end_time = 0;
-	unsigned tsc_high, tsc_low;
-	unsigned long long int start_time = 0, end_time = 0;
-	u64 difference;
-	int fd; 
-	void *map_base, *virt_addr; 
-	unsigned long writeval = 0;
-	off_t target;
-	int access_type = 'w';
-	static u32 read_data=0;
-	static double frequency = 0;
-	// If run a second time during program, just exit with the last read frequency!
+	if ( (kernel < SHF_KERNEL_AUTO) || (kernel > SHF_KERNEL_AVX512) || (kernel > SHF_block_kernel_best()) )
+		return -1;
+	block_kernel_forced = kernel;
+	return 0;
+}
 
-	// I hate warnings:
-	passed_address = passed_address;
-	start_time = start_time;
-	end_time = end_time;
-	access_type = access_type;
-	writeval = writeval;
-	read_data = read_data;
 
-/*
-	// -------------------------------
-	if (input_freq == 0.0)		
+//===========================================================
+//===========================================================
+char *SHF_block_kernel_name(int kernel)
+{
+	switch (kernel)
 		{
-		frequency = Freq_Calc(); // This will be 3.2 for 3.2 GHz
+		case SHF_KERNEL_MOVSQ:	return "rep movsq";
+		case SHF_KERNEL_SSE:		return "SSE (16B)";
+		case SHF_KERNEL_AVX2:	return "AVX2 (32B)";
+		case SHF_KERNEL_AVX512:	return "AVX-512 (64B)";
+		case SHF_KERNEL_AUTO:	return SHF_block_kernel_name(SHF_block_kernel_best());
 		}
-	else
-		frequency = input_freq;
-	// -------------------------------
-*/
-	frequency = input_freq;
-	target = passed_address;
+	return "?";
+}
 
-	if((fd = open("/dev/mem", O_RDWR | O_SYNC)) == -1) FATAL;
-	fflush(stdout);
 
-   unsigned long map_size;
-   unsigned long map_mask;
-// #define MAP_SIZE 4096UL
-// #define MAP_MASK (MAP_SIZE - 1) 
+//===========================================================
+//===========================================================
+int SHF_block_kernel_used(void)
+{
+	return block_kernel_last;
+}
 
-	map_size = ((byte_length + 0xFFF) & 0xFFFFF000);     // 4K min size and aligning
-	map_mask = map_size -1;
 
-//	SHFprint(map_size, 8, 0x10, "map_size ", "\n");
-//	SHFprint(map_mask, 8, 0x10, "map_size ", "\n");
-//  	exit(0);
+//===========================================================
+//===========================================================
+// Copies lines*64 bytes from MMIO (src) to the buffer (dst)
+static void block_kernel_read(int kernel, volatile void *src, void *dst, u64 lines)
+{
+	u64 count;
 
-/*  This did not work
-	map_size = ((byte_length + 0xF) & 0xFFFFFFF0);     // 16 byte aligning
-   map_mask = map_size-1;
-*/
-    
-	// -------------------------------
-	/* Map one page */
-//	map_base = mmap(0, MAP_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, target & ~MAP_MASK);
-	map_base = mmap(0, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, target & ~map_mask);
-	if(map_base == (void *) -1) 
+	switch (kernel)
 		{
-		printf("Address we tried to pass:\t0x%lX\n", target);
-		FATAL;
+		case SHF_KERNEL_AVX512:
+			asm volatile(
+				"1: ;"
+				"VMOVNTDQA 0x0000(%0), %%zmm0;"
+				"VMOVDQU64 %%zmm0, 0x0000(%1);"
+				"ADD $0x40, %0;"
+				"ADD $0x40, %1;"
+				"DEC %2;"
+				"JNE 1b;"
+				"VZEROUPPER;"
+				: "+r" (src), "+r" (dst), "+r" (lines) : : "xmm0", "memory", "cc");
+			break;
+
+		case SHF_KERNEL_AVX2:
+			asm volatile(
+				"1: ;"
+				"VMOVNTDQA 0x0000(%0), %%ymm0;"
+				"VMOVNTDQA 0x0020(%0), %%ymm1;"
+				"VMOVDQU %%ymm0, 0x0000(%1);"
+				"VMOVDQU %%ymm1, 0x0020(%1);"
+				"ADD $0x40, %0;"
+				"ADD $0x40, %1;"
+				"DEC %2;"
+				"JNE 1b;"
+				"VZEROUPPER;"
+				: "+r" (src), "+r" (dst), "+r" (lines) : : "xmm0", "xmm1", "memory", "cc");
+			break;
+
+		case SHF_KERNEL_SSE:
+			asm volatile(
+				"1: ;"
+				"MOVNTDQA 0x0000(%0), %%xmm0;"
+				"MOVNTDQA 0x0010(%0), %%xmm1;"
+				"MOVNTDQA 0x0020(%0), %%xmm2;"
+				"MOVNTDQA 0x0030(%0), %%xmm3;"
+				"MOVDQU %%xmm0, 0x0000(%1);"
+				"MOVDQU %%xmm1, 0x0010(%1);"
+				"MOVDQU %%xmm2, 0x0020(%1);"
+				"MOVDQU %%xmm3, 0x0030(%1);"
+				"ADD $0x40, %0;"
+				"ADD $0x40, %1;"
+				"DEC %2;"
+				"JNE 1b;"
+				: "+r" (src), "+r" (dst), "+r" (lines) : : "xmm0", "xmm1", "xmm2", "xmm3", "memory", "cc");
+			break;
+
+		default:
+			count = lines * 8;
+			asm volatile("cld; rep movsq;" : "+S" (src), "+D" (dst), "+c" (count) : : "memory", "cc");
+			break;
 		}
-	virt_addr = map_base + (target & MAP_MASK);
-	// -------------------------------
+}
 
-	u64 count = byte_length/size;			// size =1(byte) / 2(word) / 4(dword) =
-	if (byte_length%size)
-		count = count +1;	
+
+//===========================================================
+//===========================================================
+// Copies lines*64 bytes from the buffer (src) to MMIO (dst)
+static void block_kernel_write(int kernel, void *src, volatile void *dst, u64 lines)
+{
+	u64 count;
+
+	switch (kernel)
+		{
+		case SHF_KERNEL_AVX512:
+			asm volatile(
+				"1: ;"
+				"VMOVDQU64 0x0000(%0), %%zmm0;"
+				"VMOVNTDQ %%zmm0, 0x0000(%1);"
+				"ADD $0x40, %0;"
+				"ADD $0x40, %1;"
+				"DEC %2;"
+				"JNE 1b;"
+				"VZEROUPPER;"
+				: "+r" (src), "+r" (dst), "+r" (lines) : : "xmm0", "memory", "cc");
+			break;
+
+		case SHF_KERNEL_AVX2:
+			asm volatile(
+				"1: ;"
+				"VMOVDQU 0x0000(%0), %%ymm0;"
+				"VMOVDQU 0x0020(%0), %%ymm1;"
+				"VMOVNTDQ %%ymm0, 0x0000(%1);"
+				"VMOVNTDQ %%ymm1, 0x0020(%1);"
+				"ADD $0x40, %0;"
+				"ADD $0x40, %1;"
+				"DEC %2;"
+				"JNE 1b;"
+				"VZEROUPPER;"
+				: "+r" (src), "+r" (dst), "+r" (lines) : : "xmm0", "xmm1", "memory", "cc");
+			break;
+
+		case SHF_KERNEL_SSE:
+			asm volatile(
+				"1: ;"
+				"MOVDQU 0x0000(%0), %%xmm0;"
+				"MOVDQU 0x0010(%0), %%xmm1;"
+				"MOVDQU 0x0020(%0), %%xmm2;"
+				"MOVDQU 0x0030(%0), %%xmm3;"
+				"MOVNTDQ %%xmm0, 0x0000(%1);"
+				"MOVNTDQ %%xmm1, 0x0010(%1);"
+				"MOVNTDQ %%xmm2, 0x0020(%1);"
+				"MOVNTDQ %%xmm3, 0x0030(%1);"
+				"ADD $0x40, %0;"
+				"ADD $0x40, %1;"
+				"DEC %2;"
+				"JNE 1b;"
+				: "+r" (src), "+r" (dst), "+r" (lines) : : "xmm0", "xmm1", "xmm2", "xmm3", "memory", "cc");
+			break;
+
+		default:
+			count = lines * 8;
+			asm volatile("cld; rep movsq;" : "+S" (src), "+D" (dst), "+c" (count) : : "memory", "cc");
+			break;
+		}
+}
+
+
+//===========================================================
+//===========================================================
+// Moves bytes between MMIO and the buffer.  Any address, any length:  rep movsb up to the
+// first 64 byte boundary (head), the selected kernel for all the whole lines, rep movsb for
+// whatever's left (tail).  Everything's fenced per the fence policy.
+static void block_transfer(int write, volatile u8 *mmio, u8 *buffer, u64 bytes)
+{
+	int kernel;
+	u64 head, line, lines, chunk, step;
+
+	kernel = (block_kernel_forced == SHF_KERNEL_AUTO) ? SHF_block_kernel_best() : block_kernel_forced;
+	block_kernel_last = kernel;
+
+	head = (64 - ((unsigned long)mmio & 0x3F)) & 0x3F;
+	if (head > bytes)
+		head = bytes;
+	if (head)
+		{
+		if (write)
+			string_transfer(1, buffer, mmio, head, 1);
+		else
+			string_transfer(0, mmio, buffer, head, 1);
+		mmio = mmio + head;
+		buffer = buffer + head;
+		bytes = bytes - head;
+		}
+
+	lines = bytes / 64;
+	step = (block_fence_lines == 0) ? lines : block_fence_lines;
+	for (line=0; line<lines; line+=chunk)
+		{
+		chunk = ((lines - line) < step) ? (lines - line) : step;
+		if (write)
+			block_kernel_write(kernel, buffer + (line * 64), mmio + (line * 64), chunk);
+		else
+			block_kernel_read(kernel, mmio + (line * 64), buffer + (line * 64), chunk);
+		block_fence(write);
+		}
+
+	if (bytes & 0x3F)
+		{
+		if (write)
+			string_transfer(1, buffer + (lines * 64), mmio + (lines * 64), bytes & 0x3F, 1);
+		else
+			string_transfer(0, mmio + (lines * 64), buffer + (lines * 64), bytes & 0x3F, 1);
+		}
+}
+
+
+//===========================================================
+//===========================================================
+double block_read_assembly_delay_bytes(u64 passed_address, char *units, double input_freq, u64 byte_length, u8 array1[])
+{
+	unsigned tsc_high, tsc_low;
+	u64 start_time = 0, end_time = 0;
+	u64 difference;
+	volatile u8 *virt_addr;
+	off_t target;
+	double frequency;
+
+	frequency = input_freq;
+	target = passed_address;
+
+	fflush(stdout);
+
+	// -------------------------------
+	// Map exactly the pages the transfer touches (used to be number_4K_blocks*0x1000 masked off
+	// the address, which only worked for power of 2 sizes on aligned addresses)
+	virt_addr = timed_map(target, byte_length, "block_read_assembly_delay_bytes");
+	timed_buffer(array1, byte_length, 0);		// Buffer pages faulted in (or dropped, if cold) before the clock starts
+	// -------------------------------
 
 	//  ---------------------------------------------------------
 	//	Read the TSC for START TIME
@@ -1024,44 +3041,12 @@ double read_assembly_delay(u64 passed_address, char *units, double input_freq, u
 
 	start_time = ( (unsigned long long)(tsc_low) | ((unsigned long long)(tsc_high) << 32)  );
 
-
 	//  ---------------------------------------------------------
 	//	DATA READ GOES HERE 
-	// Each "Block" of this is 4K (0-0x1000)
-
-	if (size == 1)  // byte
-		{
-		   asm ("cld;"
-				  "rep movsb;"                         /* copy esi to edi */
-			 	  "MFENCE;"
-		   :                                         /* output (none) */
-		   :"S"(virt_addr), "c"(count), "D"(array1)  /* input:   %0=virt_addr (%esi), %1=count (%ecx), %2=array1 (%edi) */
-		   :"cc"		                                 /* clobbered register: %rax, %rbx, %rdx", carry-flag */
-		   ); 
-		}
-	else if (size == 2) // word
-		{
-		   asm ("cld;"
-				  "rep movsw;"                         /* copy esi to edi */
-			 	  "MFENCE;"
-		   :                                         /* output (none) */
-		   :"S"(virt_addr), "c"(count), "D"(array1)  /* input:   %0=virt_addr (%esi), %1=count (%ecx), %2=array1 (%edi) */
-		   :"cc"		                                 /* clobbered register: %rax, %rbx, %rdx", carry-flag */
-		   ); 
-		}
-	else if (size == 4) // dword
-		{
-		   asm ("cld;"
-				  "rep movsd;"                         /* copy esi to edi */
-			 	  "MFENCE;"
-		   :                                         /* output (none) */
-		   :"S"(virt_addr), "c"(count), "D"(array1)  /* input:   %0=virt_addr (%esi), %1=count (%ecx), %2=array1 (%edi) */
-		   :"cc"		                                 /* clobbered register: %rax, %rbx, %rdx", carry-flag */
-		   ); 
-		}
+	block_transfer(0, virt_addr, array1, byte_length);
 
 	//  ---------------------------------------------------------
-	//	Read the TSC for end TIME
+	//	Read the TSC for END TIME
 	asm ("LFENCE;");
    	asm volatile("rdtsc" : "=a" (tsc_low), "=d" (tsc_high) );
 	asm ("LFENCE;");        //I get diff. answers if I move LFENCE's in & out
@@ -1071,17 +3056,12 @@ double read_assembly_delay(u64 passed_address, char *units, double input_freq, u
 
 	//  ---------------------------------------------------------
 	fflush(stdout);
-	if(munmap(map_base, MAP_SIZE) == -1) FATAL;
-	close(fd);
+	timed_done(array1, byte_length);
 	//  ---------------------------------------------------------
 
 	//  ---------------------------------------------------------
 	difference = end_time-start_time;
 
-//		Debug
-//   printf("start_time:\t\t%llx\n",start_time);
-//   printf("end_time:\t\t%llx\n",end_time);
-
 	if (strncmp(units, "clocks", 6) == 0)
 		return difference;
 	if (strncmp(units, "cycles", 6) == 0)
@@ -1097,69 +3077,29 @@ double read_assembly_delay(u64 passed_address, char *units, double input_freq, u
 	return -1;
 }
 
-
 //===========================================================
 //===========================================================
-double write_assembly_delay(u64 passed_address, char *units, double input_freq, u64 byte_length, u8 array1[], u8 size)
+double block_write_assembly_delay_bytes(u64 passed_address, char *units, double input_freq, u64 byte_length, u8 array1[])
 {
 	unsigned tsc_high, tsc_low;
 	u64 start_time = 0, end_time = 0;
 	u64 difference;
-	int fd; 
-	void *map_base, *virt_addr; 
-	unsigned long writeval = 0;
+	volatile u8 *virt_addr;
 	off_t target;
-	int access_type = 'w';
-	static u32 read_data=0;
-	static double frequency = 0;
-	// If run a second time during program, just exit with the last read frequency!
-
-	// I hate warnings:
-	passed_address = passed_address;
-	start_time = start_time;
-	end_time = end_time;
-	access_type = access_type;
-	writeval = writeval;
-	read_data = read_data;
+	double frequency;
 
-/*
-	// -------------------------------
-	if (input_freq == 0.0)		
-		{
-		frequency = Freq_Calc(); // This will be 3.2 for 3.2 GHz
-		}
-	else
-		frequency = input_freq;
-	// -------------------------------
-*/
 	frequency = input_freq;
 	target = passed_address;
 
-	if((fd = open("/dev/mem", O_RDWR | O_SYNC)) == -1) FATAL;
 	fflush(stdout);
 
-   unsigned long map_size;
-   unsigned long map_mask;
-	map_size = ((byte_length + 0xFFF) & 0xFFFFF000);     // 4K min size and aligning
-	map_mask = map_size -1;
-    
 	// -------------------------------
-	/* Map one page */
-//	map_base = mmap(0, MAP_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, target & ~MAP_MASK);
-	map_base = mmap(0, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, target & ~map_mask);
-	if(map_base == (void *) -1) 
-		{
-		printf("Address we tried to pass:\t0x%lX\n", target);
-		FATAL;
-		}
-	virt_addr = map_base + (target & MAP_MASK);
+	// Map exactly the pages the transfer touches (used to be number_4K_blocks*0x1000 masked off
+	// the address, which only worked for power of 2 sizes on aligned addresses)
+	virt_addr = timed_map(target, byte_length, "block_write_assembly_delay_bytes");
+	timed_buffer(array1, byte_length, 1);		// Buffer pages faulted in (or dropped, if cold) before the clock starts
 	// -------------------------------
 
-
-	u64 count = byte_length/size;			// size =1(byte) / 2(word) / 4(dword) =
-	if (byte_length%size)
-		count = count +1;	
-
 	//  ---------------------------------------------------------
 	//	Read the TSC for START TIME
 	asm ("LFENCE;");
@@ -1169,45 +3109,12 @@ double write_assembly_delay(u64 passed_address, char *units, double input_freq,
 
 	start_time = ( (unsigned long long)(tsc_low) | ((unsigned long long)(tsc_high) << 32)  );
 
-
-
 	//  ---------------------------------------------------------
-	//	DATA READ GOES HERE 
-	// Each "Block" of this is 4K (0-0x1000)
-
-	if (size == 1)  // byte
-		{
-		   asm ("cld;"
-				  "rep movsb;"                         /* copy esi to edi */
-			 	  "MFENCE;"
-		   :                                         /* output (none) */
-		   :"S"(array1), "c"(count), "D"(virt_addr)  /* input:   %0=array1 (%esi), %1=count (%ecx), %2=virt_addr (%edi) */
-		   :"cc"		                                 /* clobbered register: %rax, %rbx, %rdx", carry-flag */
-		   ); 
-		}
-	else if (size == 2) // word
-		{
-		   asm ("cld;"
-				  "rep movsw;"                         /* copy esi to edi */
-			 	  "MFENCE;"
-		   :                                         /* output (none) */
-		   :"S"(array1), "c"(count), "D"(virt_addr)  /* input:   %0=array1 (%esi), %1=count (%ecx), %2=virt_addr (%edi) */
-		   :"cc"		                                 /* clobbered register: %rax, %rbx, %rdx", carry-flag */
-		   ); 
-		}
-	else if (size == 4) // dword
-		{
-		   asm ("cld;"
-				  "rep movsd;"                         /* copy esi to edi */
-			 	  "MFENCE;"
-		   :                                         /* output (none) */
-		   :"S"(array1), "c"(count), "D"(virt_addr)  /* input:   %0=array1 (%esi), %1=count (%ecx), %2=virt_addr (%edi) */
-		   :"cc"		                                 /* clobbered register: %rax, %rbx, %rdx", carry-flag */
-		   ); 
-		}
+	//	DATA WRITE GOES HERE 
+	block_transfer(1, virt_addr, array1, byte_length);
 
 	//  ---------------------------------------------------------
-	//	Read the TSC for end TIME
+	//	Read the TSC for END TIME
 	asm ("LFENCE;");
    	asm volatile("rdtsc" : "=a" (tsc_low), "=d" (tsc_high) );
 	asm ("LFENCE;");        //I get diff. answers if I move LFENCE's in & out
@@ -1217,8 +3124,7 @@ double write_assembly_delay(u64 passed_address, char *units, double input_freq,
 
 	//  ---------------------------------------------------------
 	fflush(stdout);
-	if(munmap(map_base, MAP_SIZE) == -1) FATAL;
-	close(fd);
+	timed_done(array1, byte_length);
 	//  ---------------------------------------------------------
 
 	//  ---------------------------------------------------------
@@ -1239,332 +3145,773 @@ double write_assembly_delay(u64 passed_address, char *units, double input_freq,
 	return -1;
 }
 
+
 //===========================================================
 //===========================================================
 double block_read_assembly_delay_new(u64 passed_address, char *units, double input_freq, u64 number_4K_blocks, u8 array1[])
 {
-//	unsigned long array1[1024] __attribute__ ((aligned(64)));
-	unsigned tsc_high, tsc_low;	
-	u64 start_time = 0, end_time = 0;
-	u64 difference;
-	int fd; 
-	void *map_base, *virt_addr; 
-	unsigned long writeval = 0;
-	off_t target;
-	int access_type = 'w';
-	static u32 read_data=0;
-	static double frequency = 0;
-	// If run a second time during program, just exit with the last read frequency!
+	return block_read_assembly_delay_bytes(passed_address, units, input_freq, number_4K_blocks * 0x1000, array1);
+}
 
-	// I hate warnings:
-	passed_address = passed_address;
-	start_time = start_time;
-	end_time = end_time;
-	access_type = access_type;
-	writeval = writeval;
-	read_data = read_data;
 
-/*
-	// -------------------------------
-	if (input_freq == 0.0)		
+//===========================================================
+//===========================================================
+double block_write_assembly_delay_new(u64 passed_address, char *units, double input_freq, u64 number_4K_blocks, u8 array1[])
+{
+	return block_write_assembly_delay_bytes(passed_address, units, input_freq, number_4K_blocks * 0x1000, array1);
+}
+
+
+//===========================================================
+//===========================================================
+// Block Port I/O
+//===========================================================
+// The io commands only ever did one in/out.  These move byte_length bytes, timed like the mem
+// routines (LFENCE/rdtsc/LFENCE around the whole transfer):
+//	fifo = 1:  All of it through ONE port - rep insb/insw/insl, rep outsb/outsw/outsl.  FIFOs.
+//	fifo = 0:  A port range - port, port+size, port+2*size ... one in/out each (there's no
+//	           string instruction that walks ports).  Legacy register blocks.
+
+//===========================================================
+//===========================================================
+static double delay_in_units(u64 difference, char *units, double frequency)
+{
+	if (strncmp(units, "clocks", 6) == 0)
+		return difference;
+	if (strncmp(units, "cycles", 6) == 0)
+		return difference;
+	if (strncmp(units, "sec", 3) == 0)
+		return difference/frequency;
+	if (strncmp(units, "ms", 2) == 0)
+		return (difference*1000)/frequency;
+	if (strncmp(units, "us", 4) == 0)
+		return (difference*1000000)/frequency;
+	if (strncmp(units, "ns", 2) == 0)
+		return (difference*1000000000)/frequency;
+	return -1;
+}
+
+
+//===========================================================
+//===========================================================
+double io_read_assembly_delay(u64 passed_address, char *units, double input_freq, u64 byte_length, u8 array1[], u8 size, int fifo)
+{
+	u16 port = passed_address;
+	u64 count, bytes, i, start_time, end_time;
+	void *dst = array1;
+
+	count = (byte_length + size - 1) / size;
+	bytes = count * size;									// rep ins/outs counts count down to 0
+	io_grant_or_die(passed_address, (fifo) ? size : bytes, "io_read_assembly_delay");
+	timed_buffer(array1, bytes, 0);
+
+	start_time = latency_tsc();
+	if (fifo)
 		{
-		frequency = Freq_Calc(); // This will be 3.2 for 3.2 GHz
+		switch (size)
+			{
+			case 1:	asm volatile ("rep insb" : "+D" (dst), "+c" (count) : "d" (port) : "memory");	break;
+			case 2:	asm volatile ("rep insw" : "+D" (dst), "+c" (count) : "d" (port) : "memory");	break;
+			default:	asm volatile ("rep insl" : "+D" (dst), "+c" (count) : "d" (port) : "memory");	break;
+			}
 		}
 	else
-		frequency = input_freq;
-	// -------------------------------
-*/
-	frequency = input_freq;
-	target = passed_address;
+		{
+		for (i=0; i<count; i++)
+			{
+			switch (size)
+				{
+				case 1:	array1[i] = inb(port + i);										break;
+				case 2:	((u16 *)array1)[i] = inw(port + (i * 2));					break;
+				default:	((u32 *)array1)[i] = inl(port + (i * 4));					break;
+				}
+			}
+		}
+	end_time = latency_tsc();
+	timed_done(array1, bytes);							// lock:  let go of the buffer again
 
-	if((fd = open("/dev/mem", O_RDWR | O_SYNC)) == -1) FATAL;
-	fflush(stdout);
+	return delay_in_units(end_time - start_time, units, input_freq);
+}
 
-// #define MAP_SIZE 4096UL
-// #define MAP_MASK (MAP_SIZE - 1)
-unsigned long map_size;
-unsigned long map_mask;
-map_size = number_4K_blocks * 0x1000;
-map_mask = map_size-1;
-    
-	// -------------------------------
-	/* Map one page */
-	map_base = mmap(0, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, target & ~map_mask);
-	if(map_base == (void *) -1) 
+
+//===========================================================
+//===========================================================
+double io_write_assembly_delay(u64 passed_address, char *units, double input_freq, u64 byte_length, u8 array1[], u8 size, int fifo)
+{
+	u16 port = passed_address;
+	u64 count, bytes, i, start_time, end_time;
+	void *src = array1;
+
+	count = (byte_length + size - 1) / size;
+	bytes = count * size;									// rep ins/outs counts count down to 0
+	io_grant_or_die(passed_address, (fifo) ? size : bytes, "io_write_assembly_delay");
+	timed_buffer(array1, bytes, 1);
+
+	start_time = latency_tsc();
+	if (fifo)
 		{
-		printf("Address we tried to pass:\t0x%lX\n", target);
-		FATAL;
+		switch (size)
+			{
+			case 1:	asm volatile ("rep outsb" : "+S" (src), "+c" (count) : "d" (port) : "memory");	break;
+			case 2:	asm volatile ("rep outsw" : "+S" (src), "+c" (count) : "d" (port) : "memory");	break;
+			default:	asm volatile ("rep outsl" : "+S" (src), "+c" (count) : "d" (port) : "memory");	break;
+			}
 		}
-	virt_addr = map_base + (target & map_mask);
-	// -------------------------------
+	else
+		{
+		for (i=0; i<count; i++)
+			{
+			switch (size)
+				{
+				case 1:	outb(array1[i], port + i);										break;
+				case 2:	outw(((u16 *)array1)[i], port + (i * 2));					break;
+				default:	outl(((u32 *)array1)[i], port + (i * 4));					break;
+				}
+			}
+		}
+	end_time = latency_tsc();
+	timed_done(array1, bytes);							// lock:  let go of the buffer again
 
+	return delay_in_units(end_time - start_time, units, input_freq);
+}
 
-	u64 count = number_4K_blocks;
 
-//		float TSC_delta;
-//  	void *map_base, *virt_addr, *HPET_base, *HPET_virt_addr; 
-//		unsigned long  HPET_start_time, HPET_end_time, HPET_delta; 
-//		float HPET_resolution = 69.841279;  // (in ns)
-//		float HPET_bandwidth, TSC_bandwidth;
+//===========================================================
+//===========================================================
+// Parallel Block Bandwidth
+//===========================================================
+// One thread copying one mapping can't tell you where a BAR or a memory controller tops out.
+// The main thread maps the whole range once (through the SHFmem_map cache, which isn't
+// thread safe - so not from the workers) and splits it into thread_count slices (64 byte
+// multiples).  Each thread is pinned to its CPU, gets its buffer slice ready and then waits.
+// When everyone's ready, the main thread picks a TSC time ~1ms out and they all start on
+// it - so nobody's setup or thread start is in anybody's number.
+struct block_bw_job
+	{
+	int cpu;
+	int write;
+	volatile u8 *mmio;				// This thread's slice of the mapping
+	u64 bytes;
+	u8 *buffer;
+	volatile int *ready;				// # of threads ready and waiting
+	volatile u64 *start_tsc;			// 0 until the main thread says go
+	u64 end_tsc;
+	int failed;
+	};
 
-/*
-	//  ---------------------------------------------------------
-	// Lets read first data to return (for testing)
-	// This will show up on Logic Analyzer
-	read_data = *((unsigned long *) virt_addr);	// DATA READ HERE
-	array1[0] = read_data;
-	//  ---------------------------------------------------------
-*/
 
-	//  ---------------------------------------------------------
-	//	Read the TSC for START TIME
-	asm ("LFENCE;");
-   	asm volatile("rdtsc" : "=a" (tsc_low), "=d" (tsc_high) );
-	asm ("LFENCE;");        //I get diff. answers if I move LFENCE's in & out
-	//  ---------------------------------------------------------
+//===========================================================
+//===========================================================
+static void *block_bw_worker(void *arg)
+{
+	struct block_bw_job *job = arg;
+	u64 start;
 
-	start_time = ( (unsigned long long)(tsc_low) | ((unsigned long long)(tsc_high) << 32)  );
+	timed_buffer(job->buffer, job->bytes, job->write);
 
-	//  ---------------------------------------------------------
-	//	DATA READ GOES HERE 
-	// Each "Block" of this is 4K (0-0x1000)
+	__sync_fetch_and_add(job->ready, 1);
+	while ((start = *job->start_tsc) == 0)
+		;
+	while (rdtsc() < start)
+		;
 
-      asm ("movq %0, %%rax; "
-	   "movq %1, %%rcx; "
-		"loop3: ;"
-//		"MOVNTDQA 0x0000(%%rax), %%xmm0;"		// %%rax = %0 = virt_addr (memory)
-//		"MOVNTDQA 0x0010(%%rax), %%xmm1;"		// READ FROM MEM => XMM
-//		"MOVNTDQA 0x0020(%%rax), %%xmm2;"
-//		"MOVNTDQA 0x0030(%%rax), %%xmm3;"
-//		"MOVDQA %%xmm0, 0x0000(%%rsi);"			// %%rsi = %2 = array1 (data)
-//		"MOVDQA %%xmm1, 0x0010(%%rsi);"			// WRITE XMM => DATA
-//		"MOVDQA %%xmm2, 0x0020(%%rsi);"
-//		"MOVDQA %%xmm3, 0x0030(%%rsi);"
-#include "code_block_read.h"
-//		"MOVNTDQA 0x0fc0(%%rax), %%xmm0;"
-//		"MOVNTDQA 0x0fd0(%%rax), %%xmm1;"
-//		"MOVNTDQA 0x0fe0(%%rax), %%xmm2;"
-//		"MOVNTDQA 0x0ff0(%%rax), %%xmm3;"
-//		"MOVDQA %%xmm0, 0x0fc0(%%rsi);"
-//		"MOVDQA %%xmm1, 0x0fd0(%%rsi);"
-//		"MOVDQA %%xmm2, 0x0fe0(%%rsi);"
-//		"MOVDQA %%xmm3, 0x0ff0(%%rsi);"
-//		"LFENCE;"
-		"MFENCE;"
-		"ADD $0x1000, %%rax;"					// Remove the $, code crashes
-		"ADD $0x1000, %%rsi;"					// Remove the $, code crashes
-		"DEC %%ecx;"
-		"JNE loop3;"
-
-      :                                         /* output (none) */
-      :"r"(virt_addr), "c"(count), "S"(array1)  /* input:   %0=virt_addr (%rax above), %1=count (%ecx %rcx above), %2=array1 (%esi) */
-      :"%rax", "cc"										/* clobbered register: %rax, carry-flag */
-      ); 
+	if (!job->failed)
+		block_transfer(job->write, job->mmio, job->buffer, job->bytes);
+	job->end_tsc = rdtsc();
 
-	//  ---------------------------------------------------------
-	//	Read the TSC for END TIME
-	asm ("LFENCE;");
-   	asm volatile("rdtsc" : "=a" (tsc_low), "=d" (tsc_high) );
-	asm ("LFENCE;");        //I get diff. answers if I move LFENCE's in & out
-	//  ---------------------------------------------------------
+	timed_done(job->buffer, job->bytes);
+	return NULL;
+}
 
-	end_time = ( (unsigned long long)(tsc_low) | ((unsigned long long)(tsc_high) << 32)  );
 
+//===========================================================
+//===========================================================
+int SHF_block_bandwidth(u64 address, u64 byte_length, int write, u8 array1[], int *cpus, int thread_count,
+								double frequency, struct SHF_bandwidth *results, double *aggregate_gbps)
+{
+	struct block_bw_job *jobs;
+	pthread_t *threads;
+	pthread_attr_t attr;
+	cpu_set_t cpu_set;
+	volatile u8 *mmio;
+	int *started;
+	volatile int ready = 0;
+	volatile u64 start_tsc = 0;
+	u64 slice, offset, last_end = 0;
+	int i, running = 0, failures = 0;
+
+	if ( (thread_count < 1) || (frequency <= 0) )
+		return -1;
+	if (byte_length < (u64)thread_count * 64)		// At least a line each
+		thread_count = (byte_length < 64) ? 1 : byte_length / 64;
+	mmio = SHFmem_map(address, byte_length);		// NULL = every thread fails
+
+	jobs = calloc(thread_count, sizeof(struct block_bw_job));
+	threads = calloc(thread_count, sizeof(pthread_t));
+	started = calloc(thread_count, sizeof(int));
+	if ( (jobs == NULL) || (threads == NULL) || (started == NULL) )
+		{
+		free(jobs); free(threads); free(started);
+		return -1;
+		}
 
-	//  ---------------------------------------------------------
-	fflush(stdout);
-	if(munmap(map_base, map_size) == -1) FATAL;
-	close(fd);
-	//  ---------------------------------------------------------
+	slice = (byte_length / thread_count) & ~0x3FULL;
+	for (i=0, offset=0; i<thread_count; i++, offset+=slice)
+		{
+		jobs[i].cpu = cpus[i];
+		jobs[i].write = write;
+		jobs[i].mmio = (mmio == NULL) ? NULL : mmio + offset;
+		jobs[i].failed = (mmio == NULL);
+		jobs[i].bytes = (i == thread_count-1) ? (byte_length - offset) : slice;
+		jobs[i].buffer = &array1[offset];
+		jobs[i].ready = &ready;
+		jobs[i].start_tsc = &start_tsc;
+
+		pthread_attr_init(&attr);
+		CPU_ZERO(&cpu_set);
+		CPU_SET(cpus[i], &cpu_set);
+		pthread_attr_setaffinity_np(&attr, sizeof(cpu_set), &cpu_set);
+		if (pthread_create(&threads[i], &attr, block_bw_worker, &jobs[i]) == 0)
+			{
+			started[i] = 1;
+			running++;
+			}
+		else
+			jobs[i].failed = 1;				// CPU offline?
+		pthread_attr_destroy(&attr);
+		}
+
+	// Everybody mapped?  Then go, 1ms from now.
+	while (ready < running)
+		sched_yield();
+	start_tsc = rdtsc() + (u64)(frequency / 1000);
+
+	for (i=0; i<thread_count; i++)
+		if (started[i])
+			pthread_join(threads[i], NULL);
+
+	for (i=0; i<thread_count; i++)
+		{
+		results[i].cpu = jobs[i].cpu;
+		results[i].bytes = jobs[i].failed ? 0 : jobs[i].bytes;
+		results[i].cycles = (jobs[i].failed || (jobs[i].end_tsc <= start_tsc)) ? 0 : jobs[i].end_tsc - start_tsc;
+		results[i].gbps = (results[i].cycles == 0) ? 0 : (double)results[i].bytes * frequency / (double)results[i].cycles / 1000000000.0;
+		if (jobs[i].failed)
+			failures++;
+		else if (jobs[i].end_tsc > last_end)
+			last_end = jobs[i].end_tsc;
+		}
+
+	// Aggregate = everything moved / start to the LAST thread done
+	*aggregate_gbps = 0;
+	if (last_end > start_tsc)
+		{
+		for (i=0, offset=0; i<thread_count; i++)
+			offset = offset + results[i].bytes;
+		*aggregate_gbps = (double)offset * frequency / (double)(last_end - start_tsc) / 1000000000.0;
+		}
+
+	free(jobs);
+	free(threads);
+	free(started);
+	return (failures == 0) ? thread_count : -1;
+}
+
+
+//===========================================================
+//===========================================================
+// Streaming Memory Dump
+//===========================================================
+// Reading a big region into one buffer and then writing it means you need RAM for all of it.
+// Instead the region goes through MEM_DUMP_BUFFERS chunk sized buffers:  this thread maps a
+// chunk, block-reads it into the next free buffer and moves on, while a writer thread empties
+// full buffers to the file in order.  Memory use is MEM_DUMP_BUFFERS * chunk, whatever the size.
+#define MEM_DUMP_BUFFERS	4
+#define MEM_DUMP_CHUNK		0x100000		// 1MB default
+
+struct mem_dump_ring
+	{
+	u8 *buffer[MEM_DUMP_BUFFERS];
+	u64 length[MEM_DUMP_BUFFERS];			// Bytes in a full buffer, 0 = empty
+	int out_fd;
+	int done;										// Reader's finished, writer drains and quits
+	int failed;										// Writer couldn't write
+	pthread_mutex_t lock;
+	pthread_cond_t changed;
+	};
+
+
+//===========================================================
+//===========================================================
+static void *mem_dump_writer(void *arg)
+{
+	struct mem_dump_ring *ring = arg;
+	u64 length, written;
+	ssize_t got;
+	int slot = 0, failed = 0;
+
+	for (;;)
+		{
+		pthread_mutex_lock(&ring->lock);
+		while ( (ring->length[slot] == 0) && (!ring->done) )
+			pthread_cond_wait(&ring->changed, &ring->lock);
+		length = ring->length[slot];
+		pthread_mutex_unlock(&ring->lock);
+		if (length == 0)
+			break;									// done, and nothing left
+
+		for (written=0; (written < length) && (!failed); written+=got)
+			{
+			got = write(ring->out_fd, ring->buffer[slot] + written, length - written);
+			if (got <= 0)
+				{
+				if ( (got == -1) && (errno == EINTR) )
+					got = 0;
+				else
+					failed = 1;
+				}
+			}
+
+		pthread_mutex_lock(&ring->lock);				// The reader checks failed under the lock
+		ring->failed = failed;
+		ring->length[slot] = 0;
+		pthread_cond_broadcast(&ring->changed);
+		pthread_mutex_unlock(&ring->lock);
+		slot = (slot + 1) % MEM_DUMP_BUFFERS;
+		}
+	return NULL;
+}
+
+
+//===========================================================
+//===========================================================
+long long SHF_mem_dump(u64 address, u64 byte_length, char *filename, u64 chunk_bytes)
+{
+	struct mem_dump_ring ring;
+	pthread_t writer;
+	void *map_base;
+	unsigned long map_size;
+	u64 offset, length;
+	int mem, slot = 0, i, failed = 0, writer_started = 0;
+
+	if (chunk_bytes == 0)
+		chunk_bytes = MEM_DUMP_CHUNK;
+
+	memset(&ring, 0, sizeof(ring));
+	if (strcmp(filename, "-") == 0)
+		ring.out_fd = 1;						// stdout
+	else
+		ring.out_fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (ring.out_fd == -1)
+		return -1;
+
+	mem = open("/dev/mem", O_RDWR | O_SYNC);
+	if (mem == -1)
+		failed = 1;
+	for (i=0; i<MEM_DUMP_BUFFERS; i++)
+		if (posix_memalign((void **)&ring.buffer[i], 64, chunk_bytes) != 0)
+			{
+			ring.buffer[i] = NULL;
+			failed = 1;
+			}
+
+	pthread_mutex_init(&ring.lock, NULL);
+	pthread_cond_init(&ring.changed, NULL);
+	if (!failed)
+		{
+		if (pthread_create(&writer, NULL, mem_dump_writer, &ring) == 0)
+			writer_started = 1;
+		else
+			failed = 1;
+		}
+
+	for (offset=0; (offset < byte_length) && (!failed); offset+=length)
+		{
+		length = ((byte_length - offset) < chunk_bytes) ? (byte_length - offset) : chunk_bytes;
+
+		// Wait for the writer to hand this buffer back
+		pthread_mutex_lock(&ring.lock);
+		while ( (ring.length[slot] != 0) && (!ring.failed) )
+			pthread_cond_wait(&ring.changed, &ring.lock);
+		failed = ring.failed;
+		pthread_mutex_unlock(&ring.lock);
+		if (failed)
+			break;
+
+		map_size = (((address + offset) & MAP_MASK) + length + MAP_MASK) & ~MAP_MASK;
+		map_base = mmap(0, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, mem, (address + offset) & ~MAP_MASK);
+		if (map_base == MAP_FAILED)
+			{
+			fprintf(stderr, "Address we tried to pass:\t0x%llX\n", (unsigned long long)(address + offset));	// out=- :  not into the data
+			failed = 1;
+			break;
+			}
+		block_transfer(0, (volatile u8 *)map_base + ((address + offset) & MAP_MASK), ring.buffer[slot], length);
+		munmap(map_base, map_size);
+
+		pthread_mutex_lock(&ring.lock);
+		ring.length[slot] = length;
+		pthread_cond_broadcast(&ring.changed);
+		pthread_mutex_unlock(&ring.lock);
+		slot = (slot + 1) % MEM_DUMP_BUFFERS;
+		}
+
+	// Let the writer drain what's left, then quit
+	pthread_mutex_lock(&ring.lock);
+	ring.done = 1;
+	pthread_cond_broadcast(&ring.changed);
+	pthread_mutex_unlock(&ring.lock);
+	if (writer_started)
+		pthread_join(writer, NULL);
+	failed = failed || ring.failed;
+
+	pthread_mutex_destroy(&ring.lock);
+	pthread_cond_destroy(&ring.changed);
+	for (i=0; i<MEM_DUMP_BUFFERS; i++)
+		free(ring.buffer[i]);
+	if (mem != -1)
+		close(mem);
+	if (ring.out_fd != 1)
+		{
+		if (close(ring.out_fd) != 0)
+			failed = 1;
+		}
+
+	return (failed) ? -1 : (long long)byte_length;
+}
 
-	//  ---------------------------------------------------------
-	difference = end_time-start_time;
+//===========================================================
+//===========================================================
+// Register Watch
+//===========================================================
+// Watching a status register used to mean running samtool in a shell loop:  a process, a
+// /dev/mem open and an mmap per sample, and no idea exactly when each one happened.  Now the
+// poller keeps the mapping, reads every channel at rate polls/sec (0 = flat out), and only
+// logs values that CHANGED, with the TSC they were read at.  Changes go into a single
+// producer/single consumer ring (no locks - head and tail each have one writer), and a drain
+// thread formats them out to the file, so a slow disk or terminal never stalls the poller.
+// If the drain thread falls a whole ring behind, changes are counted as dropped, not waited on.
+#define WATCH_RING_RECORDS	0x10000			// Must be a power of 2
+
+struct watch_ring
+	{
+	struct SHF_watch_sample *record;
+	u64 head __attribute__((aligned(64)));			// Next slot to fill (only the poller writes it)
+	u64 tail __attribute__((aligned(64)));			// Next slot to empty (only the drain thread writes it)
+	int done __attribute__((aligned(64)));			// Poller's finished.  Drain what's left and quit
+	FILE *out;
+	int binary;
+	int size;
+	int channels;
+	u64 *ids;
+	u64 start_tsc;
+	double frequency;
+	int failed;
+	};
 
-	if (strncmp(units, "clocks", 6) == 0)
-		return difference;
-	if (strncmp(units, "cycles", 6) == 0)
-		return difference;
-	if (strncmp(units, "sec", 3) == 0)
-		return difference/frequency;
-	if (strncmp(units, "ms", 2) == 0)
-		return (difference*1000)/frequency;
-	if (strncmp(units, "us", 4) == 0)
-		return (difference*1000000)/frequency;
-	if (strncmp(units, "ns", 2) == 0)
-		return (difference*1000000000)/frequency;
+static volatile sig_atomic_t watch_stop = 0;
 
 
-	return -1;
+//===========================================================
+//===========================================================
+static void watch_sigint(int sig)
+{
+	sig = sig;
+	watch_stop = 1;
+}
 
 
-	/*
-   printf("HPET Delta\t\t%f usec\n",((HPET_delta * HPET_resolution)/1000));
-   HPET_bandwidth = MAP_SIZE*count / ((HPET_delta * HPET_resolution)/1000);
-   printf("BandWidth (HPET)\t%f MB/sec\n",HPET_bandwidth);
+//===========================================================
+//===========================================================
+static void *watch_drain(void *arg)
+{
+	struct watch_ring *ring = arg;
+	struct SHF_watch_sample *record;
+	struct timespec nap = {0, 200000};				// 200us
+	u64 *last_change;
+	u64 head, tail = 0;
+	int done;
+
+	last_change = calloc(ring->channels, sizeof(u64));
+	if (last_change == NULL)
+		{
+		ring->failed = 1;
+		return NULL;
+		}
 
-   TSC_bandwidth = (MAP_SIZE*count / TSC_delta);
-   printf("BandWidth (TSC)\t\t%f MB/sec\n",TSC_bandwidth);
-	*/
-	//  ---------------------------------------------------------
+	for (;;)
+		{
+		done = __atomic_load_n(&ring->done, __ATOMIC_ACQUIRE);
+		head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+		if (tail == head)
+			{
+			if (done)
+				break;
+			fflush(ring->out);						// Caught up.  Let the user see it
+			nanosleep(&nap, NULL);
+			continue;
+			}
+
+		for (; tail != head; tail++)
+			{
+			record = &ring->record[tail & (WATCH_RING_RECORDS - 1)];
+			if (ring->binary)
+				{
+				if (fwrite(record, sizeof(*record), 1, ring->out) != 1)
+					ring->failed = 1;
+				}
+			else if (fprintf(ring->out, "%16.3f  %14.3f  0x%08llX  0x%0*llX\n",
+							(record->tsc - ring->start_tsc) * 1000000.0 / ring->frequency,
+							(last_change[record->channel]) ? (record->tsc - last_change[record->channel]) * 1000000.0 / ring->frequency : 0.0,
+							(unsigned long long)ring->ids[record->channel], ring->size * 2, (unsigned long long)record->value) < 0)
+				ring->failed = 1;
+			last_change[record->channel] = record->tsc;
+			}
+		__atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+		}
 
+	fflush(ring->out);
+	free(last_change);
+	return NULL;
 }
 
 
 //===========================================================
 //===========================================================
-double block_write_assembly_delay_new(u64 passed_address, char *units, double input_freq, u64 number_4K_blocks, u8 array1[])
+int SHF_watch(SHF_watch_reader reader, void *context, int channels, u64 *ids, int size, double rate, double seconds,
+				  char *filename, int binary, double frequency, struct SHF_watch_stats *stats)
 {
-//	unsigned long array1[1024] __attribute__ ((aligned(64)));
-	unsigned tsc_high, tsc_low;
-	u64 start_time = 0, end_time = 0;
-	u64 difference;
-	int fd; 
-	void *map_base, *virt_addr; 
-	unsigned long writeval = 0;
-	off_t target;
-	int access_type = 'w';
-	static u32 read_data=0;
-	static double frequency = 0;
-	// If run a second time during program, just exit with the last read frequency!
+	struct watch_ring ring;
+	struct SHF_watch_sample *record;
+	struct sigaction stop_action, old_action;
+	struct timespec nap = {0, 50000};				// 50us
+	pthread_t drain;
+	u64 last[SHF_WATCH_MAX_CHANNELS];
+	u64 now, next, period, end, head, value;
+	u32 version = 1, channel_count = channels;
+	int c, first = 1;
+
+	memset(stats, 0, sizeof(*stats));
+	if ( (channels < 1) || (channels > SHF_WATCH_MAX_CHANNELS) )
+		return -1;
+	if (frequency == 0)
+		frequency = Freq_Calc();
+
+	memset(&ring, 0, sizeof(ring));
+	ring.binary = binary;
+	ring.size = size;
+	ring.channels = channels;
+	ring.ids = ids;
+	ring.frequency = frequency;
+	ring.record = malloc(WATCH_RING_RECORDS * sizeof(struct SHF_watch_sample));
+	if (ring.record == NULL)
+		return -1;
+
+	if (strcmp(filename, "-") == 0)
+		ring.out = stdout;
+	else
+		ring.out = fopen(filename, (binary) ? "wb" : "w");
+	if (ring.out == NULL)
+		{
+		free(ring.record);
+		return -1;
+		}
 
+	ring.start_tsc = rdtsc();
+	if (binary)
+		{
+		fwrite("SAMWATCH", 8, 1, ring.out);
+		fwrite(&version, sizeof(version), 1, ring.out);
+		fwrite(&channel_count, sizeof(channel_count), 1, ring.out);
+		fwrite(&frequency, sizeof(frequency), 1, ring.out);
+		fwrite(&ring.start_tsc, sizeof(ring.start_tsc), 1, ring.out);
+		fwrite(ids, sizeof(u64), channels, ring.out);
+		}
+	else
+		fprintf(ring.out, "#       time(us)       delta(us)  address     value      (TSC %.6f GHz.  Changes only)\n",
+				  frequency / 1000000000);
 
+	if (pthread_create(&drain, NULL, watch_drain, &ring) != 0)
+		{
+		if (ring.out != stdout)
+			fclose(ring.out);
+		free(ring.record);
+		return -1;
+		}
 
-	// I hate warnings:
-	passed_address = passed_address;
-	start_time = start_time;
-	end_time = end_time;
-	access_type = access_type;
-	writeval = writeval;
-	read_data = read_data;
+	// Ctrl-C ends the watch (and only the watch)
+	watch_stop = 0;
+	memset(&stop_action, 0, sizeof(stop_action));
+	stop_action.sa_handler = watch_sigint;
+	sigemptyset(&stop_action.sa_mask);
+	sigaction(SIGINT, &stop_action, &old_action);
+
+	period = (rate > 0) ? (u64)(frequency / rate) : 0;
+	end = (seconds > 0) ? (u64)(seconds * frequency) : 0;
+	head = 0;
+	next = ring.start_tsc;
+	while (!watch_stop)
+		{
+		// Pace it.  Sleep off the long waits, spin the last bit so the poll lands on time
+		if (period)
+			{
+			while ((now = rdtsc()) < next)
+				{
+				if ((next - now) > (u64)(frequency / 5000))			// > 200us to go
+					nanosleep(&nap, NULL);
+				}
+			next = next + period;
+			if (next < now)
+				next = now;												// Fell behind.  Don't try to catch up in a burst
+			}
+
+		for (c=0; c<channels; c++)
+			{
+			now = rdtsc();
+			if (reader(context, c, &value) != 0)
+				{
+				stats->errors++;
+				continue;
+				}
+			if ( (!first) && (value == last[c]) )
+				continue;
+			last[c] = value;
+			stats->changes++;
+
+			if ((head - __atomic_load_n(&ring.tail, __ATOMIC_ACQUIRE)) >= WATCH_RING_RECORDS)
+				{
+				stats->dropped++;										// Drain thread's a whole ring behind
+				continue;
+				}
+			record = &ring.record[head & (WATCH_RING_RECORDS - 1)];
+			record->tsc = now;
+			record->value = value;
+			record->channel = c;
+			record->reserved = 0;
+			__atomic_store_n(&ring.head, ++head, __ATOMIC_RELEASE);
+			}
+		first = 0;
+		stats->polls++;
+
+		if ( (end) && ((now - ring.start_tsc) >= end) )
+			break;
+		}
+	stats->seconds = (rdtsc() - ring.start_tsc) / frequency;
+	sigaction(SIGINT, &old_action, NULL);
 
-/*
-	// -------------------------------
-	if (input_freq == 0.0)		
+	__atomic_store_n(&ring.done, 1, __ATOMIC_RELEASE);
+	pthread_join(drain, NULL);
+
+	if (ring.out != stdout)
 		{
-		frequency = Freq_Calc(); // This will be 3.2 for 3.2 GHz
+		if (fclose(ring.out) != 0)
+			ring.failed = 1;
 		}
-	else
-		frequency = input_freq;
-	// -------------------------------
-*/
-	frequency = input_freq;
-	target = passed_address;
+	free(ring.record);
 
-	if((fd = open("/dev/mem", O_RDWR | O_SYNC)) == -1) FATAL;
-	fflush(stdout);
-    
+	return (ring.failed) ? -1 : 0;
+}
 
-// #define MAP_SIZE 4096UL
-// #define MAP_MASK (MAP_SIZE - 1)
-unsigned long map_size;
-unsigned long map_mask;
-map_size = number_4K_blocks * 0x1000;
-map_mask = map_size-1;
-    
-	// -------------------------------
-	/* Map one page */
-	map_base = mmap(0, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, target & ~map_mask);
-	if(map_base == (void *) -1) 
+
+//===========================================================
+//===========================================================
+// Channel reader for SHF_mem_watch.  The addresses were mapped up front, so this is just the load.
+struct mem_watch_context
+	{
+	volatile void *virt[SHF_WATCH_MAX_CHANNELS];
+	int size;
+	};
+
+static int mem_watch_reader(void *context, int channel, u64 *value)
+{
+	struct mem_watch_context *mem = context;
+
+	switch (mem->size)
 		{
-		printf("Address we tried to pass:\t0x%lX\n", target);
-		FATAL;
+		case 1:	*value = *(volatile u8 *)mem->virt[channel];		break;
+		case 2:	*value = *(volatile u16 *)mem->virt[channel];	break;
+		case 4:	*value = *(volatile u32 *)mem->virt[channel];	break;
+		default:	*value = *(volatile u64 *)mem->virt[channel];	break;
 		}
-	virt_addr = map_base + (target & map_mask);
-	// -------------------------------
+	return 0;
+}
 
-	u64 count = number_4K_blocks;
 
-//		float TSC_delta;
-//  	void *map_base, *virt_addr, *HPET_base, *HPET_virt_addr; 
-//		unsigned long  HPET_start_time, HPET_end_time, HPET_delta; 
-//		float HPET_resolution = 69.841279;  // (in ns)
-//		float HPET_bandwidth, TSC_bandwidth;
+//===========================================================
+//===========================================================
+int SHF_mem_watch(u64 *addresses, int count, int size, double rate, double seconds, char *filename, int binary,
+						double frequency, struct SHF_watch_stats *stats)
+{
+	struct mem_watch_context mem;
+	int c;
 
-/*
-	//  ---------------------------------------------------------
-	// Lets read first data to return (for testing)
-	// This will show up on Logic Analyzer
-	read_data = *((unsigned long *) virt_addr);	// DATA READ HERE
-	array1[0] = read_data;
-	//  ---------------------------------------------------------
-*/
+	memset(stats, 0, sizeof(*stats));
+	if ( (count < 1) || (count > SHF_WATCH_MAX_CHANNELS) )
+		return -1;
 
-	//  ---------------------------------------------------------
-	//	Read the TSC for START TIME
-	asm ("LFENCE;");
-   	asm volatile("rdtsc" : "=a" (tsc_low), "=d" (tsc_high) );
-	asm ("LFENCE;");        //I get diff. answers if I move LFENCE's in & out
-	//  ---------------------------------------------------------
+	mem.size = size;
+	for (c=0; c<count; c++)
+		{
+		mem.virt[c] = SHFmem_map(addresses[c], size);
+		if (mem.virt[c] == NULL)
+			{
+			printf("Address we tried to pass:\t0x%llX\n", (unsigned long long)addresses[c]);
+			return -1;
+			}
+		}
 
-	start_time = ( (unsigned long long)(tsc_low) | ((unsigned long long)(tsc_high) << 32)  );
+	return SHF_watch(mem_watch_reader, &mem, count, addresses, size, rate, seconds, filename, binary, frequency, stats);
+}
 
-	//  ---------------------------------------------------------
-	//	DATA WRITE GOES HERE 
-	// Each "Block" of this is 4K (0-0x1000)
 
-      asm ("movq %0, %%rax; "
-	   "movq %1, %%rcx; "
-		"loop4: ;"
-//		"MOVNTDQA 0x0000(%%rax), %%xmm0;"
-//		"MOVNTDQA 0x0010(%%rax), %%xmm1;"
-//		"MOVNTDQA 0x0020(%%rax), %%xmm2;"
-//		"MOVNTDQA 0x0030(%%rax), %%xmm3;"
-//		"MOVDQA %%xmm0, 0x0000(%%rsi);"
-//		"MOVDQA %%xmm1, 0x0010(%%rsi);"
-//		"MOVDQA %%xmm2, 0x0020(%%rsi);"
-//		"MOVDQA %%xmm3, 0x0030(%%rsi);"
-#include "code_block_read.h"
-//		"MOVNTDQA 0x0fc0(%%rax), %%xmm0;"
-//		"MOVNTDQA 0x0fd0(%%rax), %%xmm1;"
-//		"MOVNTDQA 0x0fe0(%%rax), %%xmm2;"
-//		"MOVNTDQA 0x0ff0(%%rax), %%xmm3;"
-//		"MOVDQA %%xmm0, 0x0fc0(%%rsi);"
-//		"MOVDQA %%xmm1, 0x0fd0(%%rsi);"
-//		"MOVDQA %%xmm2, 0x0fe0(%%rsi);"
-//		"MOVDQA %%xmm3, 0x0ff0(%%rsi);"
-//		"LFENCE;"
-		"MFENCE;"
-		"ADD $0x1000, %%rax;"					// Remove the $, code crashes
-		"ADD $0x1000, %%rsi;"					// Remove the $, code crashes
-		"DEC %%ecx;"
-		"JNE loop4;"
-
-      :                                         /* output (none) */
-      :"r"(array1), "c"(count), "S"(virt_addr)  /* input:   %0=array1 (%rax above), %1=count (%ecx  %rcx above), %2=virt_addr (%esi) */
-      :"%rax", "cc"										/* clobbered register: %rax, %rsi, carry-flag */
-      ); 
+//===========================================================
+//===========================================================
+// Port watch (POST codes on 0x80, EC status ...).  Permission is granted once up front (cached), so
+// the poll loop is nothing but in instructions.
+struct io_watch_context
+	{
+	u16 port[SHF_WATCH_MAX_CHANNELS];
+	int size;
+	};
 
-	//  ---------------------------------------------------------
-	//	Read the TSC for end TIME
-	asm ("LFENCE;");
-   	asm volatile("rdtsc" : "=a" (tsc_low), "=d" (tsc_high) );
-	asm ("LFENCE;");        //I get diff. answers if I move LFENCE's in & out
-	//  ---------------------------------------------------------
+static int io_watch_reader(void *context, int channel, u64 *value)
+{
+	struct io_watch_context *io = context;
 
-	end_time = ( (unsigned long long)(tsc_low) | ((unsigned long long)(tsc_high) << 32)  );
+	switch (io->size)
+		{
+		case 1:	*value = inb(io->port[channel]);		break;
+		case 2:	*value = inw(io->port[channel]);		break;
+		default:	*value = inl(io->port[channel]);		break;
+		}
+	return 0;
+}
 
-	//  ---------------------------------------------------------
-	fflush(stdout);
-	if(munmap(map_base, map_size) == -1) FATAL;
-	close(fd);
-	//  ---------------------------------------------------------
 
-	//  ---------------------------------------------------------
-	difference = end_time-start_time;
-	if (strncmp(units, "clocks", 6) == 0)
-		return difference;
-	if (strncmp(units, "cycles", 6) == 0)
-		return difference;
-	if (strncmp(units, "sec", 3) == 0)
-		return difference/frequency;
-	if (strncmp(units, "ms", 2) == 0)
-		return (difference*1000)/frequency;
-	if (strncmp(units, "us", 4) == 0)
-		return (difference*1000000)/frequency;
-	if (strncmp(units, "ns", 2) == 0)
-		return (difference*1000000000)/frequency;
+//===========================================================
+//===========================================================
+int SHF_io_watch(u64 *ports, int count, int size, double rate, double seconds, char *filename, int binary,
+					  double frequency, struct SHF_watch_stats *stats)
+{
+	struct io_watch_context io;
+	int c;
 
-	return -1;
+	memset(stats, 0, sizeof(*stats));
+	if ( (count < 1) || (count > SHF_WATCH_MAX_CHANNELS) )
+		return -1;
+
+	io.size = size;
+	for (c=0; c<count; c++)
+		{
+		if ( ((ports[c] + size) > 0x10000) || (SHF_IO_grant(ports[c], size) != 0) )
+			{
+			printf("Port we tried to pass:\t0x%llX\n", (unsigned long long)ports[c]);
+			return -1;
+			}
+		io.port[c] = ports[c];
+		}
+
+	return SHF_watch(io_watch_reader, &io, count, ports, size, rate, seconds, filename, binary, frequency, stats);
 }
 
 //===========================================================
@@ -1595,40 +3942,401 @@ void SHF_wrmsr_new(u64 passed_address, u64 data)
 
 //===========================================================
 //===========================================================
-unsigned int PCI_Device_Found_and_Size(unsigned long bus, unsigned long device, unsigned long function)
+// 0 = Not Found.  0x100 = Normal PCI.  0x1000 (4K) = contains extended PCI regs
+// config = (at least) the first 0x100 bytes of the device's config space
+static unsigned int pci_config_size(u8 *config)
 	{
-	// unsigned int register_size = 0;		// 0 = Not Found.  255 = Normal PCI.  4096 (4K) = contains extended PCI regs
 	u16 devid = 0x01;
 	u16 vendorid = 0x01;
 	u8 capability_pointer = 0x01;
 	u8 capability_pointer_addr = 0x34;
+	int links = 0;
 
-	devid = SHFpci_read_word(bus, device, function, 0x00);
-	vendorid = SHFpci_read_word(bus, device, function, 0x02);
+	devid = config[0x00] | (config[0x01] << 8);
+	vendorid = config[0x02] | (config[0x03] << 8);
 
 	if  ( ( (devid == 0x0000) && (vendorid == 0x0000)) || 
          ( (devid == 0xFFFF) && (vendorid == 0xFFFF)) )
 		return 0x00;
 
 	// Okay, let's go look for PCI Express Capability Pointer.  If we find it, then return 4096.  Else, return 255
-	capability_pointer_addr =	SHFpci_read_byte(bus, device, function, 0x34);
+	// (48 links max - a broken list shouldn't hang us)
+	capability_pointer_addr =	config[0x34];
 
-	while (capability_pointer_addr != 0x00)
+	while ( (capability_pointer_addr != 0x00) && (links < 48) )
 		{
-		capability_pointer =	SHFpci_read_byte(bus, device, function, capability_pointer_addr);
+		capability_pointer =	config[capability_pointer_addr];
 		if (capability_pointer == 0x10)
 			return 0x1000;
 		else
-			capability_pointer_addr = SHFpci_read_byte(bus, device, function, capability_pointer_addr+1);
+			capability_pointer_addr = config[(u8)(capability_pointer_addr+1)];
+		links++;
 		}
 	return 0x100;
+	}
+
+
+//===========================================================
+//===========================================================
+unsigned int PCI_Device_Found_and_Size(unsigned long bus, unsigned long device, unsigned long function)
+	{
+	u8 config[0x100];
+
+	// Grab the whole standard header in one shot, then walk it out of the buffer
+	SHFpci_read_block(bus, device, function, 0x00, config, sizeof(config));
+
+	return pci_config_size(config);
+	}
+
+
+//===========================================================
+// Native PCI Dump
+//===========================================================
+// Replaces "sudo lspci -xxxx > file".  With sysfs, every /sys/bus/pci/devices entry is a
+// unit of work (sorted, so they come out in lspci's order) - that's the list lspci uses,
+// so SR-IOV VFs and ARI functions that don't set the multi-function bit aren't missed.
+// Each one's whole config space is one pread.  No sysfs:  every bus of domain 0 is a unit,
+// and all 32 devices x 8 functions are probed through libpci (vendor ID not 0000/FFFF -
+// same test as PCI_Device_Found_and_Size).  A pool of worker threads grabs units, and
+// the calling thread writes them out in order as they finish.
+//
+// Text output matches "lspci -n -xxxx".  Binary output is:
+//   "SAMPCI" 0x00 0x01     8 byte header
+//   then per function:  u16 domain, u8 bus, u8 (device<<3 | function), u16 length, length bytes of config
+#define PCI_DUMP_MAX_THREADS	64
+
+struct pci_dump_function
+	{
+	unsigned int domain;
+	unsigned int bus;
+	unsigned int device;
+	unsigned int function;
+	unsigned int length;					// # of config bytes we actually got
+	u8 config[0x1000];
+	struct pci_dump_function *next;
+	};
+
+struct pci_dump_unit							// One sysfs function, or (no sysfs) one bus
+	{
+	unsigned int domain;
+	unsigned int bus;
+	unsigned int device;
+	unsigned int function;
+	struct pci_dump_function *first;
+	struct pci_dump_function *last;
+	int done;
+	};
+
+struct pci_dump_job
+	{
+	struct pci_dump_unit *units;
+	int unit_count;
+	int next_unit;							// Next unit for a worker to grab (atomic)
+	int have_sysfs;
+	pthread_mutex_t lock;
+	pthread_cond_t unit_done;
+	};
+
+static pthread_mutex_t pci_libpci_lock = PTHREAD_MUTEX_INITIALIZER;
+
+
+//===========================================================
+//===========================================================
+// Reads up to length bytes of config space.  Returns # of bytes read, 0 if nothing is there.
+static unsigned int pci_dump_read(struct pci_dump_job *job, unsigned int domain, unsigned int bus, unsigned int device, unsigned int function, u8 *buffer, unsigned int length)
+{
+	char config_name[100];
+	ssize_t got;
+	int fd;
+
+	if (job->have_sysfs)
+		{
+		snprintf(config_name, sizeof(config_name), "/sys/bus/pci/devices/%04x:%02x:%02x.%x/config", domain, bus, device, function);
+		fd = open(config_name, O_RDONLY);
+		if (fd == -1)
+			return 0;							// No file = no device
+		got = pread(fd, buffer, length, 0);
+		close(fd);
+		}
+	else
+		{
+		// No sysfs.  libpci (and our ECAM cache) isn't thread safe, so one at a time
+		if (domain != 0)
+			return 0;
+		pthread_mutex_lock(&pci_libpci_lock);
+		got = SHFpci_read_block(bus, device, function, 0x00, buffer, 0x100);
+		if ( (got == 0x100) && (pci_config_size(buffer) == 0x1000) && (length >= 0x1000) )
+			got = got + SHFpci_read_block(bus, device, function, 0x100, buffer + 0x100, 0xF00);
+		pthread_mutex_unlock(&pci_libpci_lock);
+		}
+
+	if ( (got < 4) || (pci_config_size(buffer) == 0) )
+		return 0;
+	return got;
+}
+
+
+//===========================================================
+//===========================================================
+// Reads one function into a record on the end of the unit's list.  Returns the config
+// length (0 = nothing there, or no memory).
+static unsigned int pci_dump_one(struct pci_dump_job *job, struct pci_dump_unit *unit, unsigned int device, unsigned int function)
+{
+	struct pci_dump_function *record;
+	unsigned int length;
+
+	record = malloc(sizeof(struct pci_dump_function));
+	if (record == NULL)
+		return 0;
+	length = pci_dump_read(job, unit->domain, unit->bus, device, function, record->config, sizeof(record->config));
+	if (length == 0)
+		{
+		free(record);
+		return 0;
+		}
+
+	record->domain = unit->domain;
+	record->bus = unit->bus;
+	record->device = device;
+	record->function = function;
+	record->length = length;
+	record->next = NULL;
+	if (unit->last == NULL)
+		unit->first = record;
+	else
+		unit->last->next = record;
+	unit->last = record;
+	return length;
+}
+
+
+//===========================================================
+//===========================================================
+static void *pci_dump_worker(void *arg)
+{
+	struct pci_dump_job *job = arg;
+	struct pci_dump_unit *unit;
+	unsigned int device, function, length;
+	int u;
+
+	while ( (u = __sync_fetch_and_add(&job->next_unit, 1)) < job->unit_count )
+		{
+		unit = &job->units[u];
+
+		if (job->have_sysfs)
+			pci_dump_one(job, unit, unit->device, unit->function);		// sysfs already knows it's there
+		else
+			{
+			for (device=0; device<32; device++)
+				{
+				for (function=0; function<8; function++)
+					{
+					length = pci_dump_one(job, unit, device, function);
+					if ( (length == 0) && (function == 0) )
+						break;					// No function 0 = no device
+
+					// Header type bit 7 clear = single function device
+					if ( (function == 0) && (length > 0x0E) && !(unit->last->config[0x0E] & 0x80) )
+						break;
+					}
+				}
+			}
+
+		pthread_mutex_lock(&job->lock);
+		unit->done = 1;
+		pthread_cond_broadcast(&job->unit_done);
+		pthread_mutex_unlock(&job->lock);
+		}
+	return NULL;
+}
+
+
+//===========================================================
+//===========================================================
+static void pci_dump_write(FILE *out, struct pci_dump_function *record, int binary, int show_domain)
+{
+	u8 header[6];
+	unsigned int i;
+
+	if (binary)
+		{
+		header[0] = record->domain & 0xFF;
+		header[1] = (record->domain >> 8) & 0xFF;
+		header[2] = record->bus;
+		header[3] = (record->device << 3) | record->function;
+		header[4] = record->length & 0xFF;
+		header[5] = (record->length >> 8) & 0xFF;
+		fwrite(header, sizeof(header), 1, out);
+		fwrite(record->config, record->length, 1, out);
+		return;
+		}
+
+	// Same as lspci -n -xxxx:  [DDDD:]BB:DD.F CCCC: VVVV:DDDD (rev RR), then the hex dump
+	if (show_domain)
+		fprintf(out, "%04x:", record->domain);
+	fprintf(out, "%02x:%02x.%x %02x%02x: %02x%02x:%02x%02x", record->bus, record->device, record->function,
+			record->config[0x0B], record->config[0x0A],
+			record->config[0x01], record->config[0x00], record->config[0x03], record->config[0x02]);
+	if ( (record->length > 0x08) && (record->config[0x08] != 0) )
+		fprintf(out, " (rev %02x)", record->config[0x08]);
+	fprintf(out, "\n");
+
+	for (i=0; i<(record->length & ~0x0FU); i++)
+		{
+		if ((i & 0x0F) == 0)
+			fprintf(out, "%02x:", i);
+		fprintf(out, " %02x", record->config[i]);
+		if ((i & 0x0F) == 0x0F)
+			fprintf(out, "\n");
+		}
+	fprintf(out, "\n");
+}
+
 
+//===========================================================
+//===========================================================
+// qsort order for the sysfs units:  domain, bus, device, function (lspci's order)
+static int pci_dump_unit_compare(const void *a, const void *b)
+{
+	const struct pci_dump_unit *x = a, *y = b;
+
+	if (x->domain != y->domain)
+		return (x->domain < y->domain) ? -1 : 1;
+	if (x->bus != y->bus)
+		return (x->bus < y->bus) ? -1 : 1;
+	if (x->device != y->device)
+		return (x->device < y->device) ? -1 : 1;
+	if (x->function != y->function)
+		return (x->function < y->function) ? -1 : 1;
+	return 0;
+}
 
 
+//===========================================================
+//===========================================================
+// Units = every /sys/bus/pci/devices entry, sorted.  Returns # of units, -1 if there's no sysfs
+// (or no memory).
+static int pci_dump_sysfs_units(struct pci_dump_unit **units)
+{
+	struct pci_dump_unit *list = NULL, *bigger;
+	unsigned int domain, bus, device, function;
+	struct dirent *entry;
+	int count = 0, size = 0;
+	DIR *dir;
+
+	dir = opendir("/sys/bus/pci/devices");
+	if (dir == NULL)
+		return -1;
+	while ( (entry = readdir(dir)) != NULL )
+		{
+		if (sscanf(entry->d_name, "%x:%x:%x.%x", &domain, &bus, &device, &function) != 4)
+			continue;
+		if (count == size)
+			{
+			size = (size) ? size * 2 : 256;
+			bigger = realloc(list, size * sizeof(struct pci_dump_unit));
+			if (bigger == NULL)
+				{
+				free(list);
+				closedir(dir);
+				return -1;
+				}
+			list = bigger;
+			}
+		memset(&list[count], 0, sizeof(struct pci_dump_unit));
+		list[count].domain = domain;
+		list[count].bus = bus;
+		list[count].device = device;
+		list[count].function = function;
+		count++;
+		}
+	closedir(dir);
 
+	if (count)
+		qsort(list, count, sizeof(struct pci_dump_unit), pci_dump_unit_compare);
+	*units = list;
+	return count;
 }
 
 
+//===========================================================
+//===========================================================
+int SHFpci_dump_all(char *filename, int threads, int binary)
+{
+	int show_domain = 0, device_count = 0;
+	pthread_t workers[PCI_DUMP_MAX_THREADS];
+	struct pci_dump_job job;
+	struct pci_dump_function *record, *next;
+	FILE *out;
+	int i, started;
+
+	// sysfs:  one unit per function it lists.  Else every bus of domain 0, probed.
+	job.units = NULL;
+	job.unit_count = pci_dump_sysfs_units(&job.units);
+	job.have_sysfs = (job.unit_count >= 0);
+	if (!job.have_sysfs)
+		{
+		job.unit_count = 256;
+		job.units = calloc(job.unit_count, sizeof(struct pci_dump_unit));
+		if (job.units == NULL)
+			return -1;
+		for (i=0; i<job.unit_count; i++)
+			job.units[i].bus = i;
+		}
+	for (i=0; i<job.unit_count; i++)
+		if (job.units[i].domain != 0)
+			show_domain = 1;
+	job.next_unit = 0;
+	pthread_mutex_init(&job.lock, NULL);
+	pthread_cond_init(&job.unit_done, NULL);
+
+	out = fopen(filename, binary ? "wb" : "w");
+	if (out == NULL)
+		{
+		free(job.units);
+		return -1;
+		}
+	if (binary)
+		fwrite("SAMPCI\x00\x01", 8, 1, out);
+
+	if (threads <= 0)
+		threads = sysconf(_SC_NPROCESSORS_ONLN);
+	if (threads > PCI_DUMP_MAX_THREADS)
+		threads = PCI_DUMP_MAX_THREADS;
+	if (threads < 1)
+		threads = 1;
+
+	started = 0;
+	for (i=0; i<threads; i++)
+		if (pthread_create(&workers[started], NULL, pci_dump_worker, &job) == 0)
+			started++;
+	if (started == 0)
+		pci_dump_worker(&job);			// Couldn't get any threads.  Do it ourselves.
+
+	// Write the units out in order as they finish
+	for (i=0; i<job.unit_count; i++)
+		{
+		pthread_mutex_lock(&job.lock);
+		while (!job.units[i].done)
+			pthread_cond_wait(&job.unit_done, &job.lock);
+		pthread_mutex_unlock(&job.lock);
+
+		for (record = job.units[i].first; record != NULL; record = next)
+			{
+			next = record->next;
+			pci_dump_write(out, record, binary, show_domain);
+			device_count++;
+			free(record);
+			}
+		}
 
+	for (i=0; i<started; i++)
+		pthread_join(workers[i], NULL);
 
+	fclose(out);
+	pthread_cond_destroy(&job.unit_done);
+	pthread_mutex_destroy(&job.lock);
+	free(job.units);
 
+	return device_count;
+}
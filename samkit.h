@@ -22,6 +22,12 @@
  */
 // ==========================================================
 // Sam Routines
+//===========================================================
+// FATAL Recovery
+void SHF_fatal_hook(void (*hook)(void));
+// NULL (default):  a FATAL error prints why and exit(1)s.  Otherwise it prints why and calls hook,
+// which must not return (longjmp).  Only for FATALs on the thread that set it.
+
 //===========================================================
 // PCI Read Routines
 u8 SHFpci_read_byte(unsigned long bus, unsigned long device, unsigned long function, unsigned long reg);
@@ -33,6 +39,29 @@ void SHFpci_write_byte(unsigned long bus, unsigned long device, unsigned long fu
 void SHFpci_write_word(unsigned long bus, unsigned long device, unsigned long function, unsigned long reg, u16 u16_data);
 void SHFpci_write_dword(unsigned long bus, unsigned long device, unsigned long function, unsigned long reg, u32 u32_data);
 
+// PCI Block Routines
+int SHFpci_read_block(unsigned long bus, unsigned long device, unsigned long function, unsigned long reg, u8 *buffer, unsigned long length);
+int SHFpci_write_block(unsigned long bus, unsigned long device, unsigned long function, unsigned long reg, u8 *buffer, unsigned long length);
+// Reads/Writes length bytes of config space starting at reg in ONE call (a single pread/pwrite
+// on /sys/bus/pci/devices/.../config, libpci pci_read_block/pci_write_block for the rest).
+// Returns # of bytes transferred (-1 if no device handle).  Bytes that couldn't be read come back 0xFF.
+
+//===========================================================
+// PCI Session (used by all of the SHFpci_ routines above)
+struct pci_access *SHFpci_session_open(void);
+// Returns the process-wide libpci handle.  pci_alloc/pci_init only happen the first time.
+
+struct pci_dev *SHFpci_get_dev(unsigned int domain, unsigned long bus, unsigned long device, unsigned long function);
+// Returns a cached pci_dev for domain:bus:device.function (NULL on failure)
+
+void SHFpci_session_close(void);
+// Frees the cached pci_dev handles and the libpci handle.  Runs automatically at exit.
+
+void SHFpci_use_ecam(int enable);
+// enable = 1 (default):  If the ACPI MCFG table is readable and its ECAM windows can be mapped
+//   through /dev/mem, the SHFpci_ routines use plain loads/stores.  libpci otherwise.
+// enable = 0:  libpci only.
+
 //===========================================================
 // Memory Read Routines
 // Note:  I've only managed to get these Memory routines to work with MMIO addresses.
@@ -51,6 +80,29 @@ void SHFmem_write_word  (u64 passed_address, u16 u16_data);
 void SHFmem_write_dword (u64 passed_address, u32 u32_data);
 
 //===========================================================
+// Memory Mapping Cache (used by all of the SHFmem_ routines above)
+void *SHFmem_map(u64 passed_address, u64 length);
+// Returns a pointer to passed_address, mapped through /dev/mem, good for at least
+// length bytes.  The mapping is cached (LRU), so asking again is nearly free.
+// Returns NULL if it can't be mapped.  Don't hang onto the pointer across other
+// SHFmem_ calls - it can be evicted.
+
+void SHFmem_invalidate(u64 passed_address, u64 length);
+// Throws away any cached mapping that overlaps passed_address...+length
+
+void SHFmem_flush(void);
+// Throws away ALL cached mappings and closes /dev/mem
+
+//===========================================================
+// I/O Permission (used by all of the SHF_IO_ routines below)
+int SHF_IO_grant(u64 port, int length);
+// Gets permission for port..port+length-1 (ioperm) once and keeps it (cached in a bitmap of all
+// 64K ports).  Returns 0, -1 if not allowed (not root) or past 0xFFFF.
+// Per thread, like ioperm.  The SHF_IO_ routines call it themselves.
+
+void SHF_IO_release(void);
+// Gives back every port granted so far (ioperm off)
+
 // I/O Read Routines
 u8 SHF_IO_read_byte(u64 passed_address);
 u16 SHF_IO_read_word(u64 passed_address);
@@ -64,17 +116,39 @@ void SHF_IO_write_dword(u64 passed_address, u32 u32_data);
 //===========================================================
 // MSR Read Routine
 int SHF_rdmsr(int CPU_number, unsigned int MsrNum, unsigned long long *MsrVal);
-// NOTE:  YOU MUST RUN sudo modprobe msr before running these commands
+// NOTE:  The msr module must be loaded (see SHF_msr_load_module)
 // NOTE:  You MIGHT have to run sudo -s before running thes commands
 
 // MSR Write Routine
 int SHF_wrmsr (int CPU_number, unsigned int MsrNum, unsigned long long *MsrVal);
-// This write MSR command does not seem to be working
-// Leaving it here for now......but is...erroneous.
+// Writes *MsrVal to the MSR (pwrite on /dev/cpu/N/msr).  Returns 0 if it worked, -1 otherwise.
+// The /dev/cpu/N/msr file stays open after the first access, so each read/write is one syscall.
+
+int SHF_msr_load_module(int nosudo);
+// Runs "sudo modprobe msr" (or "modprobe msr" if nosudo) ONLY if /dev/cpu/0/msr isn't there
+// yet, and only the first time it's called.  Returns 0 if the msr files are there.  The answer
+// is kept - later calls don't touch the filesystem at all.
+
+int SHF_rdmsr_cpus(int *cpus, int cpu_count, unsigned int *msrs, int msr_count, unsigned long long *values);
+// Reads msr_count MSRs on each of cpu_count CPUs, all in parallel.  Each CPU's reads come
+// from a thread pinned to that CPU (no cross-CPU IPIs).
+//	values[(cpu index * msr_count) + msr index] = the data
+// Returns # of reads that failed (0 = all good), -1 if out of memory.
+
+int SHF_parse_cpu_list(char *list, int *cpus, int max_cpus);
+// "all" (every online CPU) or a list like "0,2,4-7" => cpus[].  Returns # of CPUs, -1 if the list is bad.
 
 //===========================================================
 u64 Read_HPET();
-// Read from the South Bridge's HPET timer.
+// Read from the South Bridge's HPET timer.  (Same as SHF_HPET_Read)
+
+int SHF_HPET_Open(u64 *base, double *frequency);
+// Finds the HPET (ACPI HPET table, else RCBA's HPTC register) and maps it for the life of the
+// process.  Only does the work once.  base/frequency (Hz) may be NULL.  Returns 0 if it's there.
+
+u64 SHF_HPET_Read(void);
+// HPET main counter (64 bit, one load).  32 bit counters are extended via roll-over.
+// Opens the HPET on first use.  Returns 0 if there's no HPET.
 
 //===========================================================
 u64 rdtsc(void);
@@ -82,7 +156,22 @@ u64 rdtsc(void);
 
 //===========================================================
 double Freq_Calc();
-// Calculates the CPU frequency via the HPET and TSC.
+// Returns the TSC frequency (Hz).  Figured out once per run, see SHF_Freq_Info.
+
+struct SHF_freq_info
+	{
+	double frequency;		// TSC Hz
+	double error;			// +/- Hz
+	int invariant;			// 1 = TSC doesn't change with P/C-states (CPUID 0x80000007 EDX[8])
+	char source[32];		// "CPUID 0x15", "MSR 0xCE", "CPUID 0x16", "CLOCK_MONOTONIC_RAW", "HPET"
+	};
+
+void SHF_Freq_Info(struct SHF_freq_info *info);
+// Finds the TSC frequency the fastest way that works:  CPUID 0x15, else a ~20ms calibration
+// against CLOCK_MONOTONIC_RAW (the nominal MSR 0xCE/CPUID 0x16 value is used if it's within
+// the calibration error), else a 100ms HPET loop.  info may be NULL.
+// The result is cached in $XDG_RUNTIME_DIR/samtool_tsc (or /run/samtool_tsc), keyed by boot
+// ID + CPU signature, so later runs on the same boot don't calibrate at all.
 
 //===========================================================
 double tsc_delay(u64 start_time, u64 end_time, char *units, double input_freq);
@@ -129,12 +218,99 @@ void neg_add_one(u32 *i);
 //float Xassembly_delay(u64 passed_address, char *units, u32 *read_result, float input_freq);
 // Just test routines - ignore
 
+//===========================================================
+// Latency Histogram (log-linear, HdrHistogram style)
+#define SHF_HIST_SUB_BITS		8
+#define SHF_HIST_BUCKETS		((64 - SHF_HIST_SUB_BITS + 2) << (SHF_HIST_SUB_BITS - 1))
+
+struct SHF_histogram
+	{
+	u64 count;
+	u64 min;
+	u64 max;
+	double sum;										// For the mean
+	u64 bucket[SHF_HIST_BUCKETS];
+	};
+
+void SHF_hist_init(struct SHF_histogram *hist);
+void SHF_hist_record(struct SHF_histogram *hist, u64 value);
+u64 SHF_hist_percentile(struct SHF_histogram *hist, double percentile);
+// percentile = 0-100 (50 = median).  Within 1/128 of the real sample, never outside min..max.
+
+int SHF_mem_latency(u64 address, int size, int write, u64 data, u64 repeat, u64 warmup,
+						  struct SHF_histogram *hist, u64 *overhead, u64 *last_read);
+// Times repeat size (1/2/4/8) byte reads (or writes of data, + SFENCE) of address, one at a time
+// (LFENCE/rdtsc/LFENCE around each), after warmup ones that aren't recorded.  Cycles go into hist.
+// overhead = cycles for an empty timestamp pair (NOT subtracted).  last_read = the last value read.
+// Returns 0, -1 if the address couldn't be mapped.
+
+//===========================================================
+double SHF_chase(volatile u8 *base, u64 working_set, u64 stride, int random, u64 loads);
+// Pointer chase (dependent loads) over working_set bytes at base:  a pointer every stride bytes
+// (multiple of 8), linked in order, or random = 1 for one random cycle through all of them.
+// OVERWRITES base..base+working_set with the chain.  loads = # of timed loads (0 = 4 per element,
+// 1M-16M), after one untimed lap.  Returns average TSC cycles per load, -1 on bad args/no memory.
+
+//===========================================================
+u8 *SHF_buffer(u64 bytes, int populate);
+// Transfer buffer of at least bytes (mmap'd, hugepages when >= 2MB).  Kept and handed back
+// again on the next call - only remapped if a bigger one's asked for.  populate = fault every
+// page in now (do it for timed transfers).  Without populate it's never hugetlb, so 'cold'
+// can drop its pages.  Returns NULL if it can't be had.
+
+void SHF_buffer_release(void);
+// Unmaps the SHF_buffer arena
+
+//===========================================================
+#define SHF_FENCE_DEFAULT	((u64)-1)
+
+void SHF_block_fence(u64 lines);
+// Fence policy for the timed transfer routines, in 64 byte lines between fences:
+//	1 = every line, N = every N lines, 64 = every 4K, 0 = only at the end
+// SHF_FENCE_DEFAULT = end only for rep movs (b/w/d), every 4K for the x/xb blocks.
+// Reads use MFENCE, writes (non-temporal / string stores) use SFENCE.
+
+u64 SHF_block_fence_lines(int strings);
+// The current fence policy (see SHF_block_fence):  strings = 1 for rep movs (b/w/d), 0 for x/xb
+
+//===========================================================
+void SHF_timed_pages(int cold, int lock);
+// Page policy for the timed transfer routines (read/write_assembly_delay, block_*, SHF_block_bandwidth):
+//	cold = 0:  buffer pages touched BEFORE the start timestamp (default)
+//	cold = 1:  a read's buffer pages are dropped (whole 2MB pages in a hugetlb arena), so page faults are part of the time
+//	lock = 1:  mlock the buffer for the transfer (ignored when cold - mlock faults it all in)
+// Only the buffer side:  the /dev/mem mapping is VM_IO | VM_PFNMAP, complete when mmap returns.
+
+char *SHF_timed_pages_name(void);
+// "prefaulted buffer", "prefaulted buffer, mlocked", "cold (faults timed)" ... for printing
+
 //===========================================================
 double read_assembly_delay(u64 passed_address, char *units, double input_freq, u64 byte_length, u8 array1[], u8 size); 
 
 //===========================================================
 double write_assembly_delay(u64 passed_address, char *units, double input_freq, u64 byte_length, u8 array1[], u8 size); 
 
+//===========================================================
+// Block transfer kernels (used by the block_*_assembly_delay_new routines)
+#define SHF_KERNEL_AUTO		0		// Widest one the CPU/OS supports
+#define SHF_KERNEL_MOVSQ	1		// rep movsq
+#define SHF_KERNEL_SSE		2		// MOVNTDQA/MOVNTDQ xmm   (16 bytes)
+#define SHF_KERNEL_AVX2		3		// VMOVNTDQA/VMOVNTDQ ymm (32 bytes)
+#define SHF_KERNEL_AVX512	4		// VMOVNTDQA/VMOVNTDQ zmm (64 bytes)
+
+int SHF_block_kernel_best(void);
+// Widest kernel this CPU and OS can run (CPUID + XGETBV).  Figured out once.
+
+int SHF_block_kernel_select(int kernel);
+// Forces a kernel for the block routines (SHF_KERNEL_AUTO = pick the best).
+// Returns -1 if this CPU can't run it.
+
+char *SHF_block_kernel_name(int kernel);
+// "AVX2 (32B)", etc.
+
+int SHF_block_kernel_used(void);
+// The kernel the last block transfer used.
+
 //===========================================================
 double block_read_assembly_delay_new(u64 passed_address, char *units, double input_freq, u64 number_4K_blocks, u8 array1[]);
 // This routine reads from the passed address, and uses the timestamp counter
@@ -171,10 +347,98 @@ double block_write_assembly_delay_new(u64 passed_address, char *units, double in
 // Note, if input_freq is PASSED, then don't need to run the frequency test, drastically
 // speeding things up!
 
+//===========================================================
+double block_read_assembly_delay_bytes(u64 passed_address, char *units, double input_freq, u64 byte_length, u8 array1[]);
+double block_write_assembly_delay_bytes(u64 passed_address, char *units, double input_freq, u64 byte_length, u8 array1[]);
+// Same as the _new routines, but any address and any length (in bytes).  The unaligned head
+// and the tail are done with rep movsb, all the whole 64 byte lines with the block kernel.
+// Only the pages the transfer touches get mapped.
+
+//===========================================================
+double io_read_assembly_delay(u64 passed_address, char *units, double input_freq, u64 byte_length, u8 array1[], u8 size, int fifo);
+double io_write_assembly_delay(u64 passed_address, char *units, double input_freq, u64 byte_length, u8 array1[], u8 size, int fifo);
+// Timed block port I/O of byte_length bytes (rounded up to size = 1/2/4) into/out of array1.
+//	fifo = 1:  Every access to passed_address (rep insb/w/l, rep outsb/w/l)
+//	fifo = 0:  Ports passed_address, +size, +2*size ... (one in/out each)
+// Returns the time in units (same as read_assembly_delay).  Dies if port permission is refused.
+
+//===========================================================
+struct SHF_bandwidth
+	{
+	int cpu;
+	u64 bytes;					// Bytes this thread moved (0 = its mapping failed)
+	u64 cycles;					// TSC cycles from the common start to this thread done
+	double gbps;
+	};
+
+int SHF_block_bandwidth(u64 address, u64 byte_length, int write, u8 array1[], int *cpus, int thread_count,
+								double frequency, struct SHF_bandwidth *results, double *aggregate_gbps);
+// Splits address..address+byte_length into thread_count slices, one thread per slice pinned to
+// cpus[i], all started together on a TSC time (after every thread has its mapping).  Uses the
+// block kernel and fence policy.  Slice i goes to/from array1 at its offset into the range.
+// frequency = TSC Hz.  results[] gets one entry per thread, *aggregate_gbps = all bytes /
+// (start to last thread done).  Returns # of threads used (fewer if the range is < 64B/thread),
+// -1 if a thread couldn't run.
+
+//===========================================================
+long long SHF_mem_dump(u64 address, u64 byte_length, char *filename, u64 chunk_bytes);
+// Streams address..address+byte_length to filename ("-" = stdout), chunk_bytes at a time
+// (0 = 1MB), with the block kernel.  A writer thread writes one chunk while the next is read.
+// Only 4 chunk buffers, whatever the length.  Returns bytes written, -1 on failure.
+
+//===========================================================
+// Register Watch
+#define SHF_WATCH_MAX_CHANNELS	16				// Keep under MAP_CACHE_ENTRIES - mem channels stay mapped
+
+struct SHF_watch_sample
+	{
+	u64 tsc;										// TSC just before the read that saw the new value
+	u64 value;
+	u32 channel;									// Index into the ids[] passed to SHF_watch
+	u32 reserved;
+	};
+
+struct SHF_watch_stats
+	{
+	u64 polls;										// Passes over all of the channels
+	u64 changes;									// Values that changed (the first read of each channel counts)
+	u64 dropped;									// Changes lost because the drain thread was a whole ring behind
+	u64 errors;										// Reads the reader said failed
+	double seconds;
+	};
+
+typedef int (*SHF_watch_reader)(void *context, int channel, u64 *value);
+// Reads one channel into *value.  Returns 0, or non-zero if the read failed.
+
+int SHF_watch(SHF_watch_reader reader, void *context, int channels, u64 *ids, int size, double rate, double seconds,
+				  char *filename, int binary, double frequency, struct SHF_watch_stats *stats);
+// Polls channels (1-16) rate times/sec (0 = as fast as it can) for seconds (0 = until Ctrl-C), logging only
+// changes, TSC stamped, to filename ("-" = stdout) through a lock-free ring and a drain thread.
+// size = bytes per value (text formatting).  frequency = TSC Hz (0 = Freq_Calc).
+//	binary = 0:  "time(us) delta(us) id value" per change.  delta = since that channel's last change
+//	binary = 1:  "SAMWATCH", u32 version, u32 channels, double frequency, u64 start TSC, u64 ids[channels],
+//	             then a struct SHF_watch_sample per change
+// Returns 0, -1 on failure (bad channel count, file, thread).  stats filled in either way.
+
+int SHF_mem_watch(u64 *addresses, int count, int size, double rate, double seconds, char *filename, int binary,
+						double frequency, struct SHF_watch_stats *stats);
+// SHF_watch of memory:  each address is mapped once, then read with a size (1/2/4/8) byte load.
+
+int SHF_io_watch(u64 *ports, int count, int size, double rate, double seconds, char *filename, int binary,
+					  double frequency, struct SHF_watch_stats *stats);
+// SHF_watch of I/O ports:  permission for every port is taken once, then each is read with inb/inw/inl (size 1/2/4).
+
 //===========================================================
 void SHF_wrmsr_new(u64 passed_address, u64 data);
 
 //===========================================================
 unsigned int PCI_Device_Found_and_Size(unsigned long bus, unsigned long device, unsigned long function);
 
+//===========================================================
+int SHFpci_dump_all(char *filename, int threads, int binary);
+// Dumps the config space of every function on every domain/bus to filename, using
+// threads worker threads (0 = one per online CPU).
+//	binary = 0:  Same format as "lspci -n -xxxx"
+//	binary = 1:  Compact binary ("SAMPCI" header, then domain/bus/devfn/length + data per function)
+// Returns # of functions dumped, -1 if the file couldn't be written.
 
@@ -1,13 +1,13 @@
 //===========================================================
 // To Compile:
-//	gcc -Wall -W -Werror -g samtool.c samkit.c -lpci -lm -o samtool
+//	gcc -Wall -W -Werror -g samtool.c samkit.c -lpci -lm -lpthread -o samtool
 //	   with 64 bit version installed via:  sudo apt-get install libpci-dev
 //
-//	gcc -Wall -m32 -W -Werror -g samtool.c samkit.c -lpci -lm -o samtool
+//	gcc -Wall -m32 -W -Werror -g samtool.c samkit.c -lpci -lm -lpthread -o samtool
 //	   with 32 bit version installed via:  sudo apt-get install libpci-dev:i386
 //
 // Statically
-//	gcc -static -Wall -W -Werror -g samtool.c samkit.c -lpci -lm -lz -o samtool
+//	gcc -static -Wall -W -Werror -g samtool.c samkit.c -lpci -lm -lz -lpthread -o samtool
 //	   Ignore the getpwuid error 
 // 
 // To Run:
@@ -51,18 +51,22 @@
 // Version Info
 #define COPYRIGHT_STRING "Copyright 2015, Intel Corporation"
 #define AUTHOR_STRING "Sam Fleming"
-#define VERSION_STRING "Version 1.4  (02-06-2015)"
+#define VERSION_STRING "Version 1.5  (10-17-2026)"
 // ==========================================================
 // Defines Being Used
 #include <stdbool.h>		// For bool
 #include <stdlib.h>		// abs()
 #include <math.h>		   // need for pow (exponent) ** Must use -lm compile option **
 #include <string.h>		// for strcpy
+#include <strings.h>		// strcasecmp
 #include <stdio.h>		// strcpy
 #include <ctype.h>      // string stuff
 #include <pci/pci.h>    // ** Must use -lpci compile option **
 #include <sys/io.h>		// Permits access to IO Locations
 #include <unistd.h>
+#include <time.h>			// clock_gettime
+#include <errno.h>			// errno (script file open)
+#include <setjmp.h>			// longjmp out of a samkit FATAL (shell/script)
 //===========================================================
 // Sam Routines
 #include "samkit.h"   // Header Files for routines in samkit.c that do all the heavy lifting
@@ -86,11 +90,19 @@
 											 PCI_Write_Byte,		PCI_Write_Word,		PCI_Write_Dword,         					// 23-25
 											 PCI_Dump_Device,		PCI_Dump_File,			PCI_Detailed_Help,       					// 26-28
 
-											 Generic_Help  };																						// 29
+											 Generic_Help,																							// 29
+
+											 Memory_Watch,																							// 30
+											 Memory_Latency,																						// 31
+											 Memory_Chase,																							// 32
+
+											 IO_Read_Block,		  IO_Write_Block,																	// 33-34
+											 IO_Watch  };																								// 35
 
 	struct command
 		{
 		bool nosudox;											// Did user select nosudo override?
+		bool noecamx;											// Did user select noecam (libpci only for PCI)?
 		bool helpx;												// Did user select "?"
 		bool errorx;											// Did we detect error in parser (put up detailed ? info)
 		enum high_level_command_types Command_Type;	// mem, io, msr, pci, 
@@ -107,54 +119,165 @@
 		bool Data_Valid;						// Was valid data passed? (for writes only)
 		enum access_types Access_Type;	// Read, Write
 		enum access_size Size;				// Byte, Word, Dword, XBlock
+		bool Block_Bytes;						// XBlock Length is in bytes ("xb"), not 4K blocks ("x")
 		unsigned long int Length;			// # of bytes to transfer		
 		char Filename[255];		 			// Filename (for PCI reg dump)
 		unsigned int Filename_int;			// The argv[i] parameter
+		bool Binary;							// Binary (not lspci text) PCI reg dump file
+		unsigned int Out_int;				// argv[i] of "out=file" (0 = none).  Streams an x/xb read to the file
+		unsigned int Threads;				// # of worker threads (0 = one per CPU)
+		bool Sweep;								// Bandwidth at 1, 2, 4 ... Threads threads
+		char CPU_List[255];					// CPU list (for MSR):  "ALL" or "0,2,4-7".  "" = CPU 0
+		char Address_List[255];				// Address list (for MSR):  "0x10,0x198"
+		int Kernel;								// XBlock kernel (SHF_KERNEL_xxx)
+		long Fence_Lines;						// 64 byte lines between fences (0 = only at end, -1 = no fence=, -2 = bad fence=)
+		bool Watch;								// Poll the address(es) and log changes
+		double Rate;							// Watch polls/sec (0 = as fast as possible)
+		double Watch_Time;					// Watch for this many seconds (0 = until Ctrl-C)
+		unsigned long Repeat;				// Time the single access this many times (0 = once, the old way)
+		long Warmup;							// Accesses before the timed ones (-1 = default)
+		bool Chase;								// Pointer chase latency sweep
+		bool Random;							// Chase in random order (else in stride order)
+		unsigned long Stride;				// Bytes between chase pointers
+		unsigned long long Max_Set;		// Largest chase working set (0 = not given)
+		bool Cold;								// Leave page faults in the timed window
+		bool Lock;								// mlock the buffer for timed transfers
+		bool Fifo;								// io block:  every access to the one port (rep ins/outs)
 		double passed_frequency;			// passed frequency
 		bool Display_Time;					// Does user want to display time
+		bool Failed;							// Ran, but something went wrong (shell/script count it)
 		};
 
+//===========================================================
+// shell/script:  samkit FATAL errors jump back to Execute_Line instead of exiting
+	static bool Recover_Fatal = false;
+	static jmp_buf Fatal_Recovery;
+
 //===========================================================
 // Local Routines 
+	void Init_Command(    struct command *THE_Command);
+	bool Execute_Line(int argc, char *argv[]);
+	int  Split_Line(char *line, char *program, char *args[]);
+	int  Shell(char *program);
+	int  Script(char *program, int argc, char *argv[]);
 	void parse_everything(struct command *THE_Command, int argc,      char *argv[]);
 	void Execute_Command( struct command *THE_Command, int copyargc,  char copyargv[20][255]);
 	void Not_Done_Yet(    struct command *THE_Command, int copyargc,  char copyargv[20][255]);
 	void Pretty_Output(   struct command *THE_Command, float result9, char *temp, u8 array11[], float frequency);
+	void MSR_CPUs(        struct command *THE_Command);
+	void Memory_Bandwidth(struct command *THE_Command, u8 array11[]);
+	void Memory_Dump(     struct command *THE_Command, char *filename);
+	unsigned long Buffer_Size(struct command *THE_Command);
+	bool Resolve_Frequency(struct command *THE_Command);
+	void Watch_Log(struct command *THE_Command, char copyargv[20][255]);
+	void Memory_Latency_Histogram(struct command *THE_Command);
+	void Memory_Chase_Sweep(struct command *THE_Command);
+	unsigned long long Size_Value(char *string);
+	int  List_Count(char *list);
 
 
 //===========================================================
 //===========================================================
 int main(int argc, char *argv[]) 
+	{
+	// samtool shell:  one process, many commands (mappings, PCI, MSR fds and frequency stay warm)
+	if ( (argc > 1) && (strcasecmp(argv[1], "shell") == 0) )
+		return Shell(argv[0]);
+	if ( (argc > 1) && (strcasecmp(argv[1], "script") == 0) )
+		return Script(argv[0], argc, argv);
+
+	Execute_Line(argc, argv);
+	return 0;
+	}
+
+
+//===========================================================
+//===========================================================
+// Initialize Parser Data (everything a fresh command starts out with)
+void Init_Command(struct command *THE_Command)
+	{
+	THE_Command->nosudox = false;
+	THE_Command->noecamx = false;
+	THE_Command->helpx = false;
+	THE_Command->errorx = false;
+	THE_Command->Command_Type = ll_command_none;				
+	THE_Command->Command_Final = hl_command_none;	
+	THE_Command->Address = 0;
+	THE_Command->Address_Valid = false;
+	THE_Command->Bus = 0;
+	THE_Command->Bus_Valid = false;
+	THE_Command->Device = 0;
+	THE_Command->Device_Valid = false;
+	THE_Command->Function = 0;
+	THE_Command->Function_Valid = false;
+	THE_Command->Data = 0;
+	THE_Command->Data_Valid = false;
+	THE_Command->Access_Type = access_none;				
+	THE_Command->Size = size_none;	
+	THE_Command->Length = 1;
+	THE_Command->Block_Bytes = false;
+	strcpy(THE_Command->Filename, "");
+	THE_Command->Binary = false;
+	THE_Command->Out_int = 0;
+	THE_Command->Threads = 0;
+	THE_Command->Sweep = false;
+	strcpy(THE_Command->CPU_List, "");
+	strcpy(THE_Command->Address_List, "");
+	THE_Command->Kernel = SHF_KERNEL_AUTO;
+	THE_Command->Fence_Lines = -1;									// SHF_FENCE_DEFAULT
+	THE_Command->Watch = false;
+	THE_Command->Rate = 0;
+	THE_Command->Watch_Time = 0;
+	THE_Command->Repeat = 0;
+	THE_Command->Warmup = -1;
+	THE_Command->Chase = false;
+	THE_Command->Random = false;
+	THE_Command->Stride = 64;
+	THE_Command->Max_Set = 0;
+	THE_Command->Cold = false;
+	THE_Command->Lock = false;
+	THE_Command->Fifo = false;
+	THE_Command->passed_frequency = 0;
+	THE_Command->Display_Time = 0;
+	THE_Command->Failed = false;
+	}
+
+
+//===========================================================
+//===========================================================
+// SHF_fatal_hook target while Recover_Fatal is set
+static void Fatal_Longjmp(void)
+	{
+	longjmp(Fatal_Recovery, 1);
+	}
+
+
+//===========================================================
+//===========================================================
+// One complete command:  argv[0] = program name, argv[argc] = NULL.  argv gets capitalized.
+// Returns true if the parser found an error (the detailed help has already been put up), or the
+// command failed (Failed, or a FATAL caught when Recover_Fatal is set).
+bool Execute_Line(int argc, char *argv[])
 	{
 	struct command THE_Command;
 	int copyargc;
 	char copyargv[20][255];
 	int i, j;
 
-//===========================================================
-// Initialize Parser Data
-//===========================================================
-	THE_Command.nosudox = false;
-	THE_Command.helpx = false;
-	THE_Command.errorx = false;
-	THE_Command.Command_Type = ll_command_none;				
-	THE_Command.Command_Final = hl_command_none;	
-	THE_Command.Address = 0;
-	THE_Command.Address_Valid = false;
-	THE_Command.Bus = 0;
-	THE_Command.Bus_Valid = false;
-	THE_Command.Device = 0;
-	THE_Command.Device_Valid = false;
-	THE_Command.Function = 0;
-	THE_Command.Function_Valid = false;
-	THE_Command.Data = 0;
-	THE_Command.Data_Valid = false;
-	THE_Command.Access_Type = access_none;				
-	THE_Command.Size = size_none;	
-	THE_Command.Length = 1;
-	strcpy(THE_Command.Filename, "");
-	THE_Command.passed_frequency = 0;
-	THE_Command.Display_Time = 0;
+	// copyargv only has room for 20 strings (the program name + 19 parameters) of 254 characters
+	if (argc > 20)
+		{
+		printf("Too many parameters (%d).  19 max.\n", argc - 1);
+		return true;
+		}
+	for (i=0; i<argc; i++)
+		if (strlen(argv[i]) >= sizeof(copyargv[0]))
+			{
+			printf("Parameter %d is too long (%d characters max).\n", i, (int)sizeof(copyargv[0]) - 1);
+			return true;
+			}
+
+	Init_Command(&THE_Command);
 
 //===========================================================
 // Make Copies of argc, argv
@@ -176,22 +299,6 @@ int main(int argc, char *argv[])
          }
       }
 
-//===========================================================
-// Printing All the Parameters (Debug)
-//===========================================================
-/*
-	printf("\n======================================================\n"); 
-	SHFprint(argc,1,10, "You passed ", " Parameters:\n");
-	int q;
-	for (q=0; q < argc; q++)
-		{
-		SHFprint(q,1,10, "   argc[", "] = ");
-		printf("%s\n", argv[q]);
-		} 
-	printf("\n");
-// Seems to work fine!
-*/
-
 //===========================================================
 // Let's Parse This Mutha
 //===========================================================
@@ -200,7 +307,19 @@ int main(int argc, char *argv[])
 //===========================================================
 // Execute the Commands
 //===========================================================
+	// shell/script:  a samkit FATAL (bad address, no port permission ...) fails this command, not the process
+	if (Recover_Fatal)
+		{
+		if (setjmp(Fatal_Recovery) != 0)
+			{
+			SHF_fatal_hook(NULL);
+			fflush(stderr);
+			return true;
+			}
+		SHF_fatal_hook(Fatal_Longjmp);
+		}
 	Execute_Command(&THE_Command, copyargc, copyargv);
+	SHF_fatal_hook(NULL);
 
 //===========================================================
 // Cleanup - Debug
@@ -238,16 +357,255 @@ int main(int argc, char *argv[])
 	printf("\n");
 #endif
 
-// Get rid of annoying error messages	
-//	char *tempchar;
-//	argc = argc;
-//	tempchar = argv[0];
-//	tempchar = tempchar;
+	return (THE_Command.errorx) || (THE_Command.Failed);
+	}
+
+
+//===========================================================
+//===========================================================
+// Splits line (in place) at spaces/tabs into args[] the way the shell would:  args[0] = program,
+// args[argc] = NULL.  A '#' starts a comment.  Returns argc (1 = blank line), or -1 if there are
+// more than 19 parameters.  args needs room for 21 pointers.
+int Split_Line(char *line, char *program, char *args[])
+	{
+	char *p;
+	int argcount = 0;
+
+	if ( (p = strchr(line, '#')) != NULL )
+		*p = 0;
+	args[argcount++] = program;
+	for (p=strtok(line, " \t\r\n"); (p != NULL) && (argcount < 20); p=strtok(NULL, " \t\r\n"))
+		args[argcount++] = p;
+	args[argcount] = NULL;
+	if (p != NULL)
+		return -1;
+	return argcount;
+	}
 
+
+//===========================================================
+//===========================================================
+// samtool shell
+// Reads commands (same syntax, without the "sudo samtool") from stdin and runs each one with
+// Execute_Line in THIS process, so the /dev/mem mapping cache, the PCI session, the MSR fds,
+// the transfer buffer and the calibrated frequency are only set up once.  Each command is timed.
+//		history     - list the last SHELL_HISTORY commands
+//		!!  !n      - run the last command, or command n, again
+//		quit/exit   - done (so is end of file / Ctrl-D)
+// Anything samkit treats as FATAL (no /dev/mem, no port permission ...) only fails that command.
+#define SHELL_HISTORY	1000
+#define SHELL_LINE		1024
+int Shell(char *program)
+	{
+	static char history[SHELL_HISTORY][SHELL_LINE];
+	char line[SHELL_LINE], work[SHELL_LINE], name[SHELL_LINE];
+	char *args[21], *p;
+	int count = 0, n, argcount;
+	bool interactive = isatty(0), failed;
+	struct timespec start, end;
+
+	Recover_Fatal = true;
+	if (interactive)
+		printf("samtool shell.  Same commands as the command line (ex: mem 0xFED00000 d), 'history', '!!', '!n', 'quit'.\n");
+
+	while (1)
+		{
+		if (interactive)
+			{
+			printf("samtool %d> ", count + 1);
+			fflush(stdout);
+			}
+		if (fgets(line, sizeof(line), stdin) == NULL)
+			break;
+		line[strcspn(line, "\r\n")] = 0;
+		for (p=line; isspace((unsigned char)*p); p++)
+			;
+		if (*p == 0)
+			continue;
+
+		// History recall
+		if (p[0] == '!')
+			{
+			n = (p[1] == '!') ? count : atoi(&p[1]);
+			if ( (n < 1) || (n > count) || (n <= (count - SHELL_HISTORY)) )
+				{
+				printf("%s:  No such command in history.\n", p);
+				continue;
+				}
+			strcpy(line, history[(n - 1) % SHELL_HISTORY]);
+			p = line;
+			printf("%s\n", p);
+			}
+
+		if ( (strcasecmp(p, "quit") == 0) || (strcasecmp(p, "exit") == 0) || (strcasecmp(p, "q") == 0) )
+			break;
+		if (strcasecmp(p, "history") == 0)
+			{
+			for (n = (count > SHELL_HISTORY) ? (count - SHELL_HISTORY + 1) : 1; n <= count; n++)
+				printf("%5d  %s\n", n, history[(n - 1) % SHELL_HISTORY]);
+			continue;
+			}
+
+		strcpy(history[count % SHELL_HISTORY], p);
+		count++;
+
+		strcpy(work, p);
+		snprintf(name, sizeof(name), "%s", program);					// Execute_Line capitalizes it
+		argcount = Split_Line(work, name, args);
+		if (argcount < 0)
+			{
+			printf("Too many parameters.  19 max.\n");
+			continue;
+			}
+		if ( (strcasecmp(args[1], "shell") == 0) || (strcasecmp(args[1], "script") == 0) )
+			{
+			printf("Already in the shell.\n");
+			continue;
+			}
+
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		failed = Execute_Line(argcount, args);
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		fflush(stderr);
+		printf("[%d:  %.3f ms%s]\n", count, (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1000000.0,
+			(failed) ? "  FAILED" : "");
+		}
+
+	Recover_Fatal = false;
+	if (interactive)
+		printf("\n");
 	return 0;
 	}
 
 
+//===========================================================
+//===========================================================
+// samtool script {file/-} {stop/continue}
+// Runs a file (or stdin) of commands, one per line in the command line syntax (a leading "sudo"
+// and/or "samtool" is OK, '#' = comment), all in this one process like the shell.  A line fails
+// if the parser rejects it, the command reports a failure (can't map, watch FAILED ...) or samkit
+// hits a FATAL error (caught, see Execute_Line).  stop (default) quits at the first failed line,
+// continue just counts it.  stdout is one big buffer, written out once per command, so the results
+// stay in order and binary out=- streams stay clean.  stderr stays stderr:  the script's own
+// "Line n" messages and the summary (commands/sec) go there.  Returns 1 if any line failed.
+int Script(char *program, int argc, char *argv[])
+	{
+	FILE *in;
+	char line[SHELL_LINE], name[SHELL_LINE];
+	char *args[21], **cmd;
+	int i, argcount, c;
+	unsigned long line_number = 0, commands = 0, errors = 0;
+	bool keep_going = false, failed, stopped = false;
+	struct timespec start, end;
+	double seconds;
+
+	for (i=3; i<argc; i++)
+		{
+		if (strcasecmp(argv[i], "continue") == 0)
+			keep_going = true;
+		else if (strcasecmp(argv[i], "stop") == 0)
+			keep_going = false;
+		else
+			break;
+		}
+	if ( (argc < 3) || (i < argc) )
+		{
+		fprintf(stderr, "USAGE:\tsudo %s script {file/-} {stop/continue}\n"
+			"   {file/-}              - Commands:        One per line, same syntax as the command line (- = stdin).  # = comment\n"
+			"   {stop/continue}       - Errors:          stop at the first bad line (Default), or count it and continue\n\n"
+			"EXAMPLE:\n"
+			"   sudo %s script regs.txt continue\n", program, program);
+		return 1;
+		}
+
+	in = (strcmp(argv[2], "-") == 0) ? stdin : fopen(argv[2], "r");
+	if (in == NULL)
+		{
+		fprintf(stderr, "Couldn't open %s (%s)\n", argv[2], strerror(errno));
+		return 1;
+		}
+
+	setvbuf(stdout, NULL, _IOFBF, 0x100000);
+	Recover_Fatal = true;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	while (fgets(line, sizeof(line), in) != NULL)
+		{
+		line_number++;
+		failed = false;
+		snprintf(name, sizeof(name), "%s", program);					// Execute_Line capitalizes it
+
+		if ( (strchr(line, '\n') == NULL) && (!feof(in)) )
+			{
+			while ( ((c = fgetc(in)) != EOF) && (c != '\n') )
+				;
+			fprintf(stderr, "Line %lu is too long (%d characters max).\n", line_number, SHELL_LINE - 2);
+			failed = true;
+			}
+		else if ( (argcount = Split_Line(line, name, args)) < 0 )
+			{
+			fprintf(stderr, "Line %lu:  Too many parameters.  19 max.\n", line_number);
+			failed = true;
+			}
+		else
+			{
+			// Skip "sudo" and "samtool" (or ./samtool, /usr/bin/samtool ...) if they're there
+			cmd = args;
+			if ( (argcount > 1) && (strcmp(cmd[1], "sudo") == 0) )
+				{
+				cmd[1] = cmd[0];
+				cmd++;
+				argcount--;
+				}
+			if ( (argcount > 1) && (strlen(cmd[1]) >= 7) && (strcmp(cmd[1] + strlen(cmd[1]) - 7, "samtool") == 0) )
+				{
+				cmd[1] = cmd[0];
+				cmd++;
+				argcount--;
+				}
+			if (argcount == 1)
+				continue;														// Blank line / comment
+
+			commands++;
+			if ( (strcasecmp(cmd[1], "shell") == 0) || (strcasecmp(cmd[1], "script") == 0) )
+				{
+				fprintf(stderr, "Line %lu:  %s can't be run from a script.\n", line_number, cmd[1]);
+				failed = true;
+				}
+			else
+				{
+				failed = Execute_Line(argcount, cmd);
+				fflush(stdout);												// Before the next command's stderr
+				}
+			}
+
+		if (failed)
+			{
+			errors++;
+			if (!keep_going)
+				{
+				fprintf(stderr, "*** Line %lu failed.  Stopping (use 'continue' to keep going).\n", line_number);
+				stopped = true;
+				break;
+				}
+			fprintf(stderr, "*** Line %lu failed.  Continuing.\n", line_number);
+			}
+		}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	fflush(stdout);
+	Recover_Fatal = false;
+	if (in != stdin)
+		fclose(in);
+
+	seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1000000000.0;
+	fprintf(stderr, "Script:  %lu command%s, %lu error%s%s in %.3f sec (%.0f commands/sec)\n",
+		commands, (commands == 1) ? "" : "s", errors, (errors == 1) ? "" : "s", (stopped) ? " (stopped)" : "",
+		seconds, (seconds > 0) ? commands / seconds : 0.0);
+	return (errors) ? 1 : 0;
+	}
+
+
 //===========================================================
 //===========================================================
 void parse_everything(struct command *THE_Command, int argc, char *argv[])
@@ -257,6 +615,7 @@ void parse_everything(struct command *THE_Command, int argc, char *argv[])
 	bool Write_Data_Found = false;
 	bool Address_Found = false;
 	unsigned long int temp;
+	unsigned long int numb_bytes;
 //	unsigned long int Temp_Length = 1;
 
 
@@ -290,6 +649,109 @@ void parse_everything(struct command *THE_Command, int argc, char *argv[])
 		else if (strncmp(argv[i], "NOSUDO", 6) == 0)
 			THE_Command->nosudox = true;
 
+		// -----------------------------------------------------
+		// noecam:  
+		else if (strncmp(argv[i], "NOECAM", 6) == 0)
+			THE_Command->noecamx = true;
+
+		// -----------------------------------------------------
+		// binary:  (must be ahead of SIZE - "B" is Byte!)
+		else if (strcmp(argv[i], "BINARY") == 0)
+			THE_Command->Binary = true;
+
+		// -----------------------------------------------------
+		// sweep:  
+		else if (strcmp(argv[i], "SWEEP") == 0)
+			THE_Command->Sweep = true;
+
+		// -----------------------------------------------------
+		// watch:  (must be ahead of SIZE - "W" is Word!)
+		else if (strcmp(argv[i], "WATCH") == 0)
+			THE_Command->Watch = true;
+
+		// -----------------------------------------------------
+		// rate=# / time=#:  (must be ahead of WRITE_DATA - they have an '=')
+		else if (strncmp(argv[i], "RATE=", 5) == 0)
+			THE_Command->Rate = strtod(&argv[i][5], &pEnd);
+		else if (strncmp(argv[i], "TIME=", 5) == 0)
+			THE_Command->Watch_Time = strtod(&argv[i][5], &pEnd);
+
+		// -----------------------------------------------------
+		// repeat=# / warmup=#:  (must be ahead of SIZE - "W" is Word!  And WRITE_DATA - they have an '=')
+		else if (strncmp(argv[i], "REPEAT=", 7) == 0)
+			THE_Command->Repeat = strtoul(&argv[i][7], &pEnd, 0);
+		else if (strncmp(argv[i], "WARMUP=", 7) == 0)
+			THE_Command->Warmup = strtoul(&argv[i][7], &pEnd, 0);
+
+		// -----------------------------------------------------
+		// chase / random / stride=# / max=#{K/M/G}:  (must be ahead of ADDRESS - "C" is a hex digit!)
+		else if (strcmp(argv[i], "CHASE") == 0)
+			THE_Command->Chase = true;
+		else if (strcmp(argv[i], "RANDOM") == 0)
+			THE_Command->Random = true;
+		else if (strncmp(argv[i], "STRIDE=", 7) == 0)
+			THE_Command->Stride = Size_Value(&argv[i][7]);
+		else if (strncmp(argv[i], "MAX=", 4) == 0)
+			THE_Command->Max_Set = Size_Value(&argv[i][4]);
+
+		// -----------------------------------------------------
+		// cold / lock:  (must be ahead of ADDRESS - "C" is a hex digit!)
+		else if (strcmp(argv[i], "COLD") == 0)
+			THE_Command->Cold = true;
+		else if (strcmp(argv[i], "LOCK") == 0)
+			THE_Command->Lock = true;
+		else if (strcmp(argv[i], "FIFO") == 0)
+			THE_Command->Fifo = true;
+
+		// -----------------------------------------------------
+		// out=file / out=-:  (must be ahead of WRITE_DATA - it has an '='.  Filename is case sensitive, use copyargv!)
+		else if (strncmp(argv[i], "OUT=", 4) == 0)
+			THE_Command->Out_int = i;
+
+		// -----------------------------------------------------
+		// threads=#:  (must be ahead of WRITE_DATA - it has an '=')
+		else if (strncmp(argv[i], "THREADS=", 8) == 0)
+			THE_Command->Threads = strtoul(&argv[i][8], &pEnd, 0);
+
+		// -----------------------------------------------------
+		// kernel=auto/movsq/sse/avx2/avx512:  (must be ahead of WRITE_DATA - it has an '=')
+		else if (strncmp(argv[i], "KERNEL=", 7) == 0)
+			{
+			if (strcmp(&argv[i][7], "AUTO") == 0)
+				THE_Command->Kernel = SHF_KERNEL_AUTO;
+			else if (strcmp(&argv[i][7], "MOVSQ") == 0)
+				THE_Command->Kernel = SHF_KERNEL_MOVSQ;
+			else if (strcmp(&argv[i][7], "SSE") == 0)
+				THE_Command->Kernel = SHF_KERNEL_SSE;
+			else if (strcmp(&argv[i][7], "AVX2") == 0)
+				THE_Command->Kernel = SHF_KERNEL_AVX2;
+			else if (strcmp(&argv[i][7], "AVX512") == 0)
+				THE_Command->Kernel = SHF_KERNEL_AVX512;
+			else
+				THE_Command->Kernel = -1;
+			}
+
+		// -----------------------------------------------------
+		// fence=line/4k/end/#:  (must be ahead of FREQUENCY and ADDRESS - "F" is both!)
+		else if (strncmp(argv[i], "FENCE=", 6) == 0)
+			{
+			if (strcmp(&argv[i][6], "LINE") == 0)
+				THE_Command->Fence_Lines = 1;
+			else if (strcmp(&argv[i][6], "4K") == 0)
+				THE_Command->Fence_Lines = 64;
+			else if (strcmp(&argv[i][6], "END") == 0)
+				THE_Command->Fence_Lines = 0;
+			else if (isdigit(argv[i][6]))
+				THE_Command->Fence_Lines = strtoul(&argv[i][6], &pEnd, 0);
+			else
+				THE_Command->Fence_Lines = -2;
+			}
+
+		// -----------------------------------------------------
+		// cpu=all / cpu=#,#-#:  (must be ahead of ADDRESS - "C" is a hex digit!)
+		else if (strncmp(argv[i], "CPU=", 4) == 0)
+			strcpy(THE_Command->CPU_List, &argv[i][4]);
+
 		// -----------------------------------------------------
 		// FILENAME:  (Last parameter and pci already given)
 		// Must move before the Address (was crashing on filenames starting with "A"-"F"!)
@@ -327,6 +789,11 @@ void parse_everything(struct command *THE_Command, int argc, char *argv[])
 			THE_Command->Size = Dword;
 		else if (strncmp(argv[i], "DWORD", 5) == 0)
 			THE_Command->Size = Dword;
+		else if (strcmp(argv[i], "XB") == 0)				// Must be ahead of "X"
+			{
+			THE_Command->Size = XBlock;
+			THE_Command->Block_Bytes = true;
+			}
 		else if (strncmp(argv[i], "X", 1) == 0)
 			THE_Command->Size = XBlock;
 		else if (strncmp(argv[i], "BLOCK", 5) == 0)
@@ -415,6 +882,10 @@ void parse_everything(struct command *THE_Command, int argc, char *argv[])
 				THE_Command->Address_Valid = true;
 				Address_Found = true;
 
+				// More than one address:  ex:  msr 0x10,0x198
+				if ( strchr(argv[i], ',') )
+					strcpy(THE_Command->Address_List, argv[i]);
+
 				// Write data included with Address:  ex:  mem 0xA000=0x34
 				if ( strchr(argv[i], '=')  )			// Does string contain a ':' and this argcv is not f=
 					{
@@ -482,8 +953,22 @@ void parse_everything(struct command *THE_Command, int argc, char *argv[])
 	else if (THE_Command->Command_Type == mem)
 		{
 		// Valid Checks:  Address							Data (write only)   
-		if ( (THE_Command->Address_Valid == false)                                           ||		// No Addres
-			  ( (THE_Command->Access_Type == Write) && (THE_Command->Data_Valid == false) ) )			// Write, no Data
+		if ( (THE_Command->Chase) &&
+			  ( (THE_Command->Access_Type == Write) || ((THE_Command->Address_Valid) && (THE_Command->Max_Set == 0)) ||	// Mapped needs max=
+				 (THE_Command->Stride < 8) || (THE_Command->Stride % 8) ) )															// Pointer per stride
+			{
+			THE_Command->Command_Final = Memory_Detailed_Help;
+			THE_Command->errorx = true;
+			}
+		else if (THE_Command->Chase)
+			THE_Command->Command_Final = Memory_Chase;											// No address = local buffer
+		else if ( (THE_Command->Address_Valid == false)                                           ||		// No Addres
+			  ( (THE_Command->Access_Type == Write) && (THE_Command->Data_Valid == false) )  ||		// Write, no Data
+			  (THE_Command->Kernel < 0) || (THE_Command->Fence_Lines < -1)                     ||		// Bad kernel=/fence=
+			  ( (THE_Command->Out_int) && (THE_Command->Access_Type == Write) )                ||		// out= is read only
+			  ( (THE_Command->Watch) && ((THE_Command->Access_Type == Write) || (THE_Command->Size == XBlock)) ) ||	// watch is b/w/d reads
+			  ( (THE_Command->Watch) && (List_Count(THE_Command->Address_List) > SHF_WATCH_MAX_CHANNELS) )  ||		// watch:  16 addresses max
+			  ( (THE_Command->Repeat) && ((THE_Command->Watch) || (THE_Command->Size == XBlock)) ) )					// repeat= is b/w/d
 			{
 			THE_Command->Command_Final = Memory_Detailed_Help;
 			THE_Command->errorx = true;
@@ -523,6 +1008,11 @@ void parse_everything(struct command *THE_Command, int argc, char *argv[])
 				THE_Command->Command_Final = Memory_Write_Dword;
 			if ( (THE_Command->Access_Type == Write) && (THE_Command->Size == XBlock) )
 				THE_Command->Command_Final = Memory_Write_XMM;
+
+			if (THE_Command->Watch)
+				THE_Command->Command_Final = Memory_Watch;
+			if (THE_Command->Repeat)
+				THE_Command->Command_Final = Memory_Latency;
 			}
 		}
 
@@ -531,7 +1021,9 @@ void parse_everything(struct command *THE_Command, int argc, char *argv[])
 		{
 		// Valid Checks:  Address							Data (write only)		(XMM)   
 		if ( (THE_Command->Address_Valid == false) ||		// No Addres
-			  (THE_Command->Size == XBlock) )					// XMM not allowed on IO
+			  (THE_Command->Size == XBlock) ||					// XMM not allowed on IO
+			  ( (THE_Command->Watch) && ((THE_Command->Access_Type == Write) || (THE_Command->Fifo) || (THE_Command->Length > 1)) ) ||	// watch is b/w/d reads
+			  ( (THE_Command->Watch) && (List_Count(THE_Command->Address_List) > SHF_WATCH_MAX_CHANNELS) ) )		// watch:  16 ports max
 			{
 			THE_Command->Command_Final = IO_Detailed_Help;
 			THE_Command->errorx = true;
@@ -567,6 +1059,19 @@ void parse_everything(struct command *THE_Command, int argc, char *argv[])
 				THE_Command->Command_Final = IO_Write_Word;
 			if ( (THE_Command->Access_Type == Write) && (THE_Command->Size == Dword) )
 				THE_Command->Command_Final = IO_Write_Dword;
+
+			// Block mode:  fifo, or more bytes than one access.  A port range can't run off the end of IO space
+			numb_bytes = (THE_Command->Size == Byte) ? 1 : (THE_Command->Size == Word) ? 2 : 4;
+			if ( (THE_Command->Fifo) || (THE_Command->Length > numb_bytes) )
+				THE_Command->Command_Final = (THE_Command->Access_Type == Read) ? IO_Read_Block : IO_Write_Block;
+			if ( (!THE_Command->Fifo) && ((THE_Command->Address + THE_Command->Length) > 0x10000) )
+				{
+				THE_Command->Command_Final = IO_Detailed_Help;
+				THE_Command->errorx = true;
+				}
+
+			if (THE_Command->Watch)
+				THE_Command->Command_Final = IO_Watch;
 			}
 		}
 
@@ -655,24 +1160,40 @@ void parse_everything(struct command *THE_Command, int argc, char *argv[])
 void Execute_Command(struct command *THE_Command, int copyargc, char copyargv[20][255])
 	{
 	int q;
+	int io_size;
 	float result9;
 	float temp_result9;
  	char temp[10];
 	u8 u8return_data6 = 0x00;
 	u16 u16return_data6 = 0x00;
 	u32 u32return_data6 = 0x00;
-	float frequency9;
 //	u8 array11[0x400000];		// 4MB array  (worked!)
 // u8 array11[0x800000];		// 8MB array (Didn't work!)
 	u8 *array11;
 
 
 	unsigned long long ret = 0;
-	char tempstr[100];
-	unsigned int cx;
 	unsigned int Found_Size;  // Device Not Found = 0x00.  = 255/4K otherwise.
 
-	array11 =  malloc(0x40000000 * sizeof(u8));		// 1GB
+	array11 = SHF_buffer(Buffer_Size(THE_Command), (THE_Command->Display_Time) && (!THE_Command->Cold));		// Used to be a 1GB malloc every time
+	if (array11 == NULL)
+		{
+		printf("Couldn't get a 0x%lX byte buffer for this command.  Try a shorter length.\n", Buffer_Size(THE_Command));
+		THE_Command->Failed = true;
+		return;
+		}
+
+	// Every option is set (or put back) on every command - the shell/script run many in one process
+	SHFpci_use_ecam(!THE_Command->noecamx);				// noecam = libpci only
+	SHF_block_fence((THE_Command->Fence_Lines < 0) ? SHF_FENCE_DEFAULT : (u64)THE_Command->Fence_Lines);
+	SHF_timed_pages(THE_Command->Cold, THE_Command->Lock);
+
+	if (SHF_block_kernel_select(THE_Command->Kernel) != 0)		// AUTO un-forces a kernel=
+		{
+		printf("This CPU can't run the %s kernel.  Using %s.\n", SHF_block_kernel_name(THE_Command->Kernel),
+			SHF_block_kernel_name(SHF_KERNEL_AUTO));
+		SHF_block_kernel_select(SHF_KERNEL_AUTO);
+		}
 
 
 // ----- Generic Help -----------------------------------------------------------------------------------------------------------
@@ -692,13 +1213,17 @@ void Execute_Command(struct command *THE_Command, int copyargc, char copyargv[20
 			"                                                           (# of 4K blocks for xmm)\n"
 			"                                                           (max of 512MB = 0x20000000/0x20000 for xmm))\n"
 			"  {?}                   - Extended Help                    (with {mem/io/msr/pci} )\n"
-			"  {f{=#.#}}             - Measure Time.    Freq in GHz     (#.# Opt - Else tool calculates using HPET/TSC)\n\n"
+			"  {f{=#.#}}             - Measure Time.    Freq in GHz     (#.# Opt - Else tool finds TSC freq)\n\n"
 
 			"EXAMPLE:  sudo %s mem 0xFFFFFFF0 d 0x10 f\n"
 			"  Memory Read from 0xFFFFFFF0 (dword access).  Total of 0x10 bytes read.  Measure latency/performance\n"
 			"                                                                          [BIOS Boot Vector]\n\n"
-			"EXAMPLE:  sudo %s {mem/io/msr/pci} ?    Extended Help & Examples  \n\n",
-			copyargv[0], copyargv[0], copyargv[0]);
+			"EXAMPLE:  sudo %s {mem/io/msr/pci} ?    Extended Help & Examples  \n\n"
+			"EXAMPLE:  sudo %s shell                 Interactive:  one command per line (history, !!, !n, quit).\n"
+			"                                        Mappings, PCI, MSR fds and the TSC frequency stay set up.\n"
+			"EXAMPLE:  sudo %s script regs.txt       Same, from a file ('-' = stdin).  Buffered output, commands/sec.\n"
+			"                                        ('continue' after the file:  don't stop at a bad line)\n\n",
+			copyargv[0], copyargv[0], copyargv[0], copyargv[0], copyargv[0]);
       printf("---------------------------------------------------------------------------------------------------\n"); 
 	
 //		if (THE_Command->Command_Type == hl_command_none)
@@ -725,11 +1250,25 @@ void Execute_Command(struct command *THE_Command, int copyargc, char copyargv[20
 		fprintf(stderr, "USAGE:\tsudo %s mem address {=data (for write)} {b/w/d/x} {length} {f{=#.#}}\n"
 			"  {address}             - Address:         0x#########\n"
 			"  {=data (for writes)}  - Data to Write:   =0x####             (Opt.  Only for Writes.  In Hexadecimal)\n"
-			"  {b/w/d/x}             - Access Size:     Byte/Word/DWord/XMM (Opt.  Defaults to Byte)\n"
+			"  {b/w/d/x/xb}          - Access Size:     Byte/Word/DWord/XMM (Opt.  Defaults to Byte)\n"
 			"  {length (total size)} - # of Bytes TOTAL                     (Opt.  Defaults to Access Size)\n"
-  			"                                                               (# of 4K blocks for xmm)\n"
+  			"                                                               (# of 4K blocks for xmm, bytes for xb)\n"
 			"                                                               (max of 512MB = 0x20000000 {0x20000 for xmm})\n"
-			"  {f{=#.#}}             - Measure Time.    Freq in GHz         (#.# Optional.  Otherwise tool calculates)\n\n"
+			"  {f{=#.#}}             - Measure Time.    Freq in GHz         (#.# Optional.  Otherwise tool calculates)\n"
+			"  {kernel=...}          - XMM Kernel:      auto/movsq/sse/avx2/avx512 (Opt.  Defaults to widest the CPU has)\n"
+			"  {fence=...}           - Fence Every:     line/#(lines)/4k/end (Opt.  Defaults: end for b/w/d, 4k for x/xb.  Timed transfers)\n"
+			"  {threads=#} {cpu=...} - Parallel XMM:    Split x/xb across pinned threads.  GB/s per thread + total\n"
+			"  {sweep}               - Thread Sweep:    Parallel XMM at 1, 2, 4 ... threads\n"
+			"  {out=file}            - Stream To File:  x/xb read streamed to file ('out=-' = stdout).  Constant memory\n"
+			"  {watch}               - Watch:           Poll b/w/d address{,address...}, log changes w/ time (to out= too)\n"
+			"  {rate=#} {time=#}     - Watch Pacing:    Polls/sec (Opt. flat out), seconds (Opt. until Ctrl-C)\n"
+			"  {repeat=#} {warmup=#} - Latency:         Time the b/w/d access # times.  min/p50/p90/p99/p99.9/max\n"
+			"                                           (warmup Opt.  Defaults to 100 unrecorded accesses first)\n"
+			"  {chase} {max=#}       - Pointer Chase:   Latency vs. working set, 4K..max (K/M/G ok).  No address = local\n"
+			"  {random} {stride=#}   - Chase Pattern:   Random order (Opt.), bytes apart (Opt.  Defaults to 64)\n"
+			"                                           (with an address:  max= required, the range is OVERWRITTEN)\n"
+			"  {cold} {lock}         - Timed Pages:     cold = time page faults too (Opt.  Default prefaults first)\n"
+			"                                           lock = mlock buffer (Opt.)\n\n"
 
 
 			"EXAMPLES:\n"
@@ -748,8 +1287,14 @@ void Execute_Command(struct command *THE_Command, int copyargc, char copyargv[20
   			"  sudo %s mem 0x90000000 x 0x40 f=2.0     Mem. Rd.from 0x90000000        Block Read. (0x40*4k)=256KB consecutive\n"
   			"                                                                                bytes read using XMM instructions.\n"
   			"                                                                                Use 2.0Ghz for freq.\n"
-  			"                                                                                                                 [MMIO]\n",
-			copyargv[0], copyargv[0], copyargv[0], copyargv[0], copyargv[0], copyargv[0]);
+  			"                                                                                                                 [MMIO]\n"
+  			"  sudo %s mem 0xFED000F0 d watch rate=1000 time=2   Log each change of 0xFED000F0, 1000 polls/sec for 2 sec.\n"
+  			"                                                                                                           [HPET Timer]\n"
+  			"  sudo %s mem 0xFED000F0 d repeat=100000       Latency distribution of 100000 Dword reads of 0xFED000F0.\n"
+  			"                                                                                                           [HPET Timer]\n"
+  			"  sudo %s mem chase random max=4G              Random pointer chase, local memory, 4KB to 4GB working sets.\n"
+  			"                                                                                                    [L1/L2/LLC/DRAM]\n",
+			copyargv[0], copyargv[0], copyargv[0], copyargv[0], copyargv[0], copyargv[0], copyargv[0], copyargv[0], copyargv[0]);
       printf("---------------------------------------------------------------------------------------------------\n"); 
 	
 		if (THE_Command->errorx)
@@ -769,16 +1314,29 @@ void Execute_Command(struct command *THE_Command, int copyargc, char copyargv[20
 	if (THE_Command->Command_Final == IO_Detailed_Help)
 		{
       printf("\n===================================================================================================\n"); 
-		fprintf(stderr, "USAGE:\tsudo %s io address {=data (for write)} {b/w/d} \n"
+		fprintf(stderr, "USAGE:\tsudo %s io address {=data (for write)} {b/w/d} {length} {fifo} {f=#.##}\n"
+			"\tsudo %s io port{,port...} {b/w/d} watch {rate=#} {time=#} {out=file} {binary}\n"
 			"   {address}             - Address:         0x#########\n"
 			"   {=data (for writes)}  - Data to Write:   =0x####             (Optional.  Only for Writes.  In Hexadecimal)\n"
-			"   {b/w/d}               - Access Size:     Byte/Word/DWord     (Optional.  Defaults to Byte)\n\n"
+			"   {b/w/d}               - Access Size:     Byte/Word/DWord     (Optional.  Defaults to Byte)\n"
+			"   {length}              - Bytes:           0x####              (Optional.  > access size = block:  ports address,\n"
+			"                                                                 address+size ... one in/out each)\n"
+			"   {fifo}                - FIFO:            fifo                (Optional.  All length bytes through the ONE port,\n"
+			"                                                                 rep ins/outs.  Dump shows offsets, not ports)\n"
+			"   {f=#.##}              - Time the block:  f=3.2               (Optional.  GHz.  Just f calculates it)\n"
+			"   {watch}               - Watch:           Poll the port(s), log changes w/ time (to out= too).  Up to 16 ports\n"
+			"   {rate=#} {time=#}     - Watch Pacing:    Polls/sec (Opt. flat out), seconds (Opt. until Ctrl-C)\n\n"
 
 			"EXAMPLES:\n"
 		   "   sudo %s io 0x80        IO Rd. from        0x80.   Byte Access (Default).  1 Byte Read (Default). [Port 0x80]\n"
 		   "   sudo %s io 0x80=0xBA   IO Wr. of 0xBA to  0x80    Byte Access (defined by data).                 [Port 0x80]\n"
-		   "   sudo %s io 0xCF8 d     IO Rd. from        0xCF8.  Dword Access.                         [PCI CONFIG_ADDRESS]\n",
-			copyargv[0], copyargv[0], copyargv[0], copyargv[0]);
+		   "   sudo %s io 0xCF8 d     IO Rd. from        0xCF8.  Dword Access.                         [PCI CONFIG_ADDRESS]\n"
+		   "   sudo %s io 0x70 b 0x10 IO Rd. of ports    0x70-0x7F.  16 Byte Accesses.\n"
+		   "   sudo %s io 0x1F0 w fifo 0x200 f\n"
+		   "                          IO Rd. of 0x200 bytes from 0x1F0 (256 Word Accesses, rep insw), timed. [ATA Data]\n"
+		   "   sudo %s io 0x80 watch out=post.log\n"
+		   "                          Log every POST code change on 0x80, TSC stamped, until Ctrl-C.     [Port 0x80]\n",
+			copyargv[0], copyargv[0], copyargv[0], copyargv[0], copyargv[0], copyargv[0], copyargv[0], copyargv[0]);
       printf("---------------------------------------------------------------------------------------------------\n"); 
 	
 		if (THE_Command->errorx)
@@ -798,19 +1356,21 @@ void Execute_Command(struct command *THE_Command, int copyargc, char copyargv[20
 	if (THE_Command->Command_Final == MSR_Detailed_Help)
 		{
       printf("\n===================================================================================================\n"); 
-		fprintf(stderr, "USAGE:\tsudo %s msr address {=data (for write)} {nosudo}\n"
-			"   {address}             - Address:         0x#########\n"
+		fprintf(stderr, "USAGE:\tsudo %s msr address{,address...} {=data (for write)} {cpu=all/#,#-#} {nosudo}\n"
+			"   {address}             - Address:         0x#########  (Reads:  up to 16, comma separated)\n"
 			"   {=data (for writes)}  - Data to Write:   =0x####     (Optional.  Only for Writes.  In Hexadecimal)\n"
+			"   {cpu=all/#,#-#}       - CPUs:            all, 0,2,4-7 (Optional.  Defaults to CPU 0.  Read in parallel)\n"
 			"   {nosudo}              - nosudo option                (Optional.  Omit 'sudo' from modprobe msr cmd)\n\n"
 
 			"NOTE:\n"
-		   "   'sudo modprobe msr' executed before the msr command is issued.\n\n"
+		   "   'sudo modprobe msr' executed before the msr command is issued (only if msr module isn't loaded).\n\n"
 
 			"EXAMPLES:\n"
 		   "   sudo %s msr 0x10         MSR Rd. from        0x10                                       [Time Stamp Counter]\n"
 		   "   sudo %s msr 0x10 nosudo  MSR Rd. from        0x10 (omit 'sudo' from 'modprobe msr' cmd) [Time Stamp Counter]\n"
-		   "   sudo %s msr 0xC3=0x10    MSR Wr. of 0x10 to  0xC3                                       [Gen. Perf. Counter]\n",
-			copyargv[0], copyargv[0], copyargv[0], copyargv[0]);
+		   "   sudo %s msr 0xC3=0x10    MSR Wr. of 0x10 to  0xC3                                       [Gen. Perf. Counter]\n"
+		   "   sudo %s msr 0x10,0x198 cpu=all   MSR Rd. of 0x10 and 0x198 on every CPU          [TSC, Perf. Status]\n",
+			copyargv[0], copyargv[0], copyargv[0], copyargv[0], copyargv[0]);
       printf("---------------------------------------------------------------------------------------------------\n"); 
 	
 		if (THE_Command->errorx)
@@ -827,10 +1387,12 @@ void Execute_Command(struct command *THE_Command, int copyargc, char copyargv[20
 	if (THE_Command->Command_Final == PCI_Detailed_Help)
 		{
       printf("\n===================================================================================================\n"); 
-		fprintf(stderr, "USAGE:\tsudo %s pci {BB:DD.F-{R}} {=data (for write)} {nosudo} {Filename} \n"
+		fprintf(stderr, "USAGE:\tsudo %s pci {BB:DD.F-{R}} {=data (for write)} {noecam} {binary} {threads=#} {Filename} \n"
 			"   {BB:DD.F-{R}}         - Bus:Device.Function-Register                  ({R} Optional. Dumps Whole BB:DD.F if missing)\n"
 			"   {=data (for writes)}  - Data to Write =0x####                         (Optional.     Only for Writes.  In Hexadecimal)\n"
-			"   {nosudo}              - nosudo option                                 (Optional.     Omit 'sudo' before lspci -xxxx cmd)\n"
+			"   {noecam}              - noecam option                                 (Optional.     libpci only.  No direct ECAM/MMCONFIG access)\n"
+			"   {binary}              - binary option                                 (Optional.     Compact binary dump file, not lspci text)\n"
+			"   {threads=#}           - # of threads for dump file                    (Optional.     Defaults to one per CPU)\n"
 			"   {Filename}            - Filename (MUST BE LAST PARAMETER IF PRESENT!) (Optional.     Dumps all PCI Regs to File)\n\n"
 
 			"EXAMPLES:\n"
@@ -838,7 +1400,7 @@ void Execute_Command(struct command *THE_Command, int copyargc, char copyargv[20
 		   "  sudo %s pci 00:0x1F.00-04=0x0FFF  PCI Wr. of 0x0FFF to 00:0x1F.00-04     Word Access.       [PCI CMD Reg]\n"
 		   "  sudo %s pci 00:0x1D.00            PCI Rd. from 00:0x1D.00                Entire PCI space read. [USB Cnt]\n"
 		   "  sudo %s pci Registers.txt         PCI Rd. of Entire PCI Space.           Stored in filename, Registers.txt\n"
-		   "  %s pci nosudo Registers.txt       PCI Rd. of Entire PCI Space. (no sudo) Stored in filename, Registers.txt\n",
+		   "  sudo %s pci binary Registers.bin  PCI Rd. of Entire PCI Space.           Stored (binary) in Registers.bin\n",
 			copyargv[0], copyargv[0], copyargv[0], copyargv[0], copyargv[0], copyargv[0]);
       printf("---------------------------------------------------------------------------------------------------\n"); 
 	
@@ -863,14 +1425,8 @@ void Execute_Command(struct command *THE_Command, int copyargc, char copyargv[20
 		if (THE_Command->Length < 1)		// If user didn't pick a length (in bytes), need to make sure at least a word
 			THE_Command->Length = 1;
 
-		if ( (THE_Command->passed_frequency == (double)0.0) && (THE_Command->Display_Time) )
-			{
-			printf("You didn't pass a system frequency via command line parameter 'f=#.##'\n");
-			printf("Please wait five seconds. Using HPET and TSC to calculate System Frequency.\n");
-			frequency9 = Freq_Calc(); // This will be 3.2 for 3.2 GHz
-			printf("Calculated Frequency \t= %f GHz\n\n", frequency9/1000000000);
-			THE_Command->passed_frequency = frequency9/1000000000;
-			}
+		if ( (THE_Command->Display_Time) && (!Resolve_Frequency(THE_Command)) )
+			return;
 /*
 		// This works perfectly
 		address9 = 0xFFFFFFF0;
@@ -911,14 +1467,8 @@ void Execute_Command(struct command *THE_Command, int copyargc, char copyargv[20
 		if (THE_Command->Length < 2)		// If user didn't pick a length (in bytes), need to make sure at least a word
 			THE_Command->Length = 2;
 
-		if ( (THE_Command->passed_frequency == (double)0.0) && (THE_Command->Display_Time) )
-			{
-			printf("You didn't pass a system frequency via command line parameter 'f=#.##'\n");
-			printf("Please wait five seconds. Using HPET and TSC to calculate System Frequency.\n");
-			frequency9 = Freq_Calc(); // This will be 3.2 for 3.2 GHz
-			printf("Calculated Frequency \t= %f GHz\n\n", frequency9/1000000000);
-			THE_Command->passed_frequency = frequency9/1000000000;
-			}
+		if ( (THE_Command->Display_Time) && (!Resolve_Frequency(THE_Command)) )
+			return;
 		result9 = read_assembly_delay(THE_Command->Address, temp, THE_Command->passed_frequency*1000000000, THE_Command->Length, array11, 2);
 		Pretty_Output(THE_Command, result9, temp, array11, THE_Command->passed_frequency);
 		}
@@ -932,14 +1482,8 @@ void Execute_Command(struct command *THE_Command, int copyargc, char copyargv[20
 		if (THE_Command->Length < 4)		// If user didn't pick a length (in bytes), need to make sure at least a dword
 			THE_Command->Length = 4;
 
-		if ( (THE_Command->passed_frequency == (double)0.0) && (THE_Command->Display_Time) )
-			{
-			printf("You didn't pass a system frequency via command line parameter 'f=#.##'\n");
-			printf("Please wait five seconds. Using HPET and TSC to calculate System Frequency.\n");
-			frequency9 = Freq_Calc(); // This will be 3.2 for 3.2 GHz
-			printf("Calculated Frequency \t= %f GHz\n\n", frequency9/1000000000);
-			THE_Command->passed_frequency = frequency9/1000000000;
-			}
+		if ( (THE_Command->Display_Time) && (!Resolve_Frequency(THE_Command)) )
+			return;
 		result9 = read_assembly_delay(THE_Command->Address, temp, THE_Command->passed_frequency*1000000000, THE_Command->Length, array11, 4);
 		Pretty_Output(THE_Command, result9, temp, array11, THE_Command->passed_frequency);
 		}
@@ -950,20 +1494,29 @@ void Execute_Command(struct command *THE_Command, int copyargc, char copyargv[20
 		{
 		strcpy(temp, "us");
 
-		if (THE_Command->Length < 1)		// If user didn't pick a length (in 4K byte blocks), need to make sure at least x1
+		if (THE_Command->Length < 1)		// If user didn't pick a length (in 4K byte blocks, or bytes for xb), need to make sure at least x1
 			THE_Command->Length = 1;
 
-		if ( (THE_Command->passed_frequency == (double)0.0) && (THE_Command->Display_Time) )
+		// out=file:  stream it to the file (nothing to stdout - it might BE the file)
+		if (THE_Command->Out_int)
 			{
-			printf("You didn't pass a system frequency via command line parameter 'f=#.##'\n");
-			printf("Please wait five seconds. Using HPET and TSC to calculate System Frequency.\n");
-			frequency9 = Freq_Calc(); // This will be 3.2 for 3.2 GHz
-			printf("Calculated Frequency \t= %f GHz\n\n", frequency9/1000000000);
-			THE_Command->passed_frequency = frequency9/1000000000;
+			Memory_Dump(THE_Command, &copyargv[THE_Command->Out_int][4]);
+			return;
 			}
 
-		result9 = block_read_assembly_delay_new(THE_Command->Address, temp, THE_Command->passed_frequency*1000000000, THE_Command->Length, array11);
-		Pretty_Output(THE_Command, result9, temp, array11, THE_Command->passed_frequency);
+		if ( (THE_Command->Display_Time) && (!Resolve_Frequency(THE_Command)) )
+			return;
+
+		if ( (THE_Command->Threads) || (strcmp(THE_Command->CPU_List, "") != 0) || (THE_Command->Sweep) )
+			Memory_Bandwidth(THE_Command, array11);
+		else
+			{
+			if (THE_Command->Block_Bytes)
+				result9 = block_read_assembly_delay_bytes(THE_Command->Address, temp, THE_Command->passed_frequency*1000000000, THE_Command->Length, array11);
+			else
+				result9 = block_read_assembly_delay_new(THE_Command->Address, temp, THE_Command->passed_frequency*1000000000, THE_Command->Length, array11);
+			Pretty_Output(THE_Command, result9, temp, array11, THE_Command->passed_frequency);
+			}
 		}
 
 // ----- Memory Write Byte ------------------------------------------------------------------------------------------------------
@@ -975,18 +1528,12 @@ void Execute_Command(struct command *THE_Command, int copyargc, char copyargv[20
 		if (THE_Command->Length < 1)		// If user didn't pick a length (in bytes), need to make sure at least a byte
 			THE_Command->Length = 1;
 
-		if ( (THE_Command->passed_frequency == (double)0.0) && (THE_Command->Display_Time) )
-			{
-			printf("You didn't pass a system frequency via command line parameter 'f=#.##'\n");
-			printf("Please wait five seconds. Using HPET and TSC to calculate System Frequency.\n");
-			frequency9 = Freq_Calc(); // This will be 3.2 for 3.2 GHz
-			printf("Calculated Frequency \t= %f GHz\n\n", frequency9/1000000000);
-			THE_Command->passed_frequency = frequency9/1000000000;
-			}
+		if ( (THE_Command->Display_Time) && (!Resolve_Frequency(THE_Command)) )
+			return;
 
 		// Need to set array11 up with the write data
 		q = 0;
-		while (q<4096)
+		while ( (q < 4096) || ((unsigned long)q < THE_Command->Length) )
 			{
 			array11[q]=(THE_Command->Data & 0x000000FF);
 			q = q+1;
@@ -1008,18 +1555,12 @@ void Execute_Command(struct command *THE_Command, int copyargc, char copyargv[20
 		if (THE_Command->Length < 2)		// If user didn't pick a length (in bytes), need to make sure at least a word
 			THE_Command->Length = 2;
 
-		if ( (THE_Command->passed_frequency == (double)0.0) && (THE_Command->Display_Time) )
-			{
-			printf("You didn't pass a system frequency via command line parameter 'f=#.##'\n");
-			printf("Please wait five seconds. Using HPET and TSC to calculate System Frequency.\n");
-			frequency9 = Freq_Calc(); // This will be 3.2 for 3.2 GHz
-			printf("Calculated Frequency \t= %f GHz\n\n", frequency9/1000000000);
-			THE_Command->passed_frequency = frequency9/1000000000;
-			}
+		if ( (THE_Command->Display_Time) && (!Resolve_Frequency(THE_Command)) )
+			return;
 
 		// Need to set array11 up with the write data
 		q = 0;
-		while (q<4096)
+		while ( (q < 4096) || ((unsigned long)q < THE_Command->Length) )
 			{
 			array11[q]=   (THE_Command->Data & 0x000000FF);
 			array11[q+1]=((THE_Command->Data & 0x0000FF00)>>8);
@@ -1042,18 +1583,12 @@ void Execute_Command(struct command *THE_Command, int copyargc, char copyargv[20
 		if (THE_Command->Length < 4)		// If user didn't pick a length (in bytes), need to make sure at least a dword
 			THE_Command->Length = 4;
 
-		if ( (THE_Command->passed_frequency == (double)0.0) && (THE_Command->Display_Time) )
-			{
-			printf("You didn't pass a system frequency via command line parameter 'f=#.##'\n");
-			printf("Please wait five seconds. Using HPET and TSC to calculate System Frequency.\n");
-			frequency9 = Freq_Calc(); // This will be 3.2 for 3.2 GHz
-			printf("Calculated Frequency \t= %f GHz\n\n", frequency9/1000000000);
-			THE_Command->passed_frequency = frequency9/1000000000;
-			}
+		if ( (THE_Command->Display_Time) && (!Resolve_Frequency(THE_Command)) )
+			return;
 
 		// Need to set array11 up with the write data
 		q = 0;
-		while (q<4096)
+		while ( (q < 4096) || ((unsigned long)q < THE_Command->Length) )
 			{
 			array11[q]=   (THE_Command->Data & 0x000000FF);
 			array11[q+1]=((THE_Command->Data & 0x0000FF00)>>8);
@@ -1075,20 +1610,15 @@ void Execute_Command(struct command *THE_Command, int copyargc, char copyargv[20
 		{
 		strcpy(temp, "us");
 
-		if (THE_Command->Length < 1)		// If user didn't pick a length (in 4K byte blocks), need to make sure at least x1
+		if (THE_Command->Length < 1)		// If user didn't pick a length (in 4K byte blocks, or bytes for xb), need to make sure at least x1
 			THE_Command->Length = 1;
 
-		if ( (THE_Command->passed_frequency == (double)0.0) && (THE_Command->Display_Time) )
-			{
-			printf("You didn't pass a system frequency via command line parameter 'f=#.##'\n");
-			printf("Please wait five seconds. Using HPET and TSC to calculate System Frequency.\n");
-			frequency9 = Freq_Calc(); // This will be 3.2 for 3.2 GHz
-			printf("Calculated Frequency \t= %f GHz\n\n", frequency9/1000000000);
-			THE_Command->passed_frequency = frequency9/1000000000;
-			}
+		if ( (THE_Command->Display_Time) && (!Resolve_Frequency(THE_Command)) )
+			return;
 
+		// Pattern has to cover the whole transfer (used to stop at 64KB - longer writes sent malloc garbage)
 		q = 0;
-		while (q<0x10000)
+		while ( (q < 0x10000) || ((unsigned long)q < (THE_Command->Block_Bytes ? THE_Command->Length : THE_Command->Length*0x1000)) )
 			{
 			array11[q]=    (THE_Command->Data & 0x00000000000000FF);
 			array11[q+1]= ((THE_Command->Data & 0x000000000000FF00)>>8);
@@ -1109,11 +1639,43 @@ void Execute_Command(struct command *THE_Command, int copyargc, char copyargv[20
 			q = q+0x10;		// XMM instructions send 16 bytes at a time (I can only handle ull, I'm afraid.
 			}
 
-		temp_result9 = block_write_assembly_delay_new(THE_Command->Address, temp, THE_Command->passed_frequency*1000000000, THE_Command->Length, array11);
+		if ( (THE_Command->Threads) || (strcmp(THE_Command->CPU_List, "") != 0) || (THE_Command->Sweep) )
+			Memory_Bandwidth(THE_Command, array11);
+		else
+			{
+			if (THE_Command->Block_Bytes)
+				temp_result9 = block_write_assembly_delay_bytes(THE_Command->Address, temp, THE_Command->passed_frequency*1000000000, THE_Command->Length, array11);
+			else
+				temp_result9 = block_write_assembly_delay_new(THE_Command->Address, temp, THE_Command->passed_frequency*1000000000, THE_Command->Length, array11);
 
-		// The user wants to see the data read back, confirm read:
-		result9 = block_read_assembly_delay_new(THE_Command->Address, temp, THE_Command->passed_frequency*1000000000, THE_Command->Length, array11);
-		Pretty_Output(THE_Command, temp_result9, temp, array11, THE_Command->passed_frequency);
+			// The user wants to see the data read back, confirm read:
+			if (THE_Command->Block_Bytes)
+				result9 = block_read_assembly_delay_bytes(THE_Command->Address, temp, THE_Command->passed_frequency*1000000000, THE_Command->Length, array11);
+			else
+				result9 = block_read_assembly_delay_new(THE_Command->Address, temp, THE_Command->passed_frequency*1000000000, THE_Command->Length, array11);
+			Pretty_Output(THE_Command, temp_result9, temp, array11, THE_Command->passed_frequency);
+			}
+		}
+
+// ----- Memory Watch -----------------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------------------------------------
+	if (THE_Command->Command_Final == Memory_Watch)
+		Watch_Log(THE_Command, copyargv);
+
+// ----- Memory Latency ---------------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------------------------------------
+	if (THE_Command->Command_Final == Memory_Latency)
+		{
+		if (Resolve_Frequency(THE_Command))
+			Memory_Latency_Histogram(THE_Command);
+		}
+
+// ----- Memory Chase -----------------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------------------------------------
+	if (THE_Command->Command_Final == Memory_Chase)
+		{
+		if (Resolve_Frequency(THE_Command))
+			Memory_Chase_Sweep(THE_Command);
 		}
 
 // ----- IO Read Byte -----------------------------------------------------------------------------------------------------------
@@ -1194,53 +1756,75 @@ void Execute_Command(struct command *THE_Command, int copyargc, char copyargv[20
 		printf("============================================================\n\n");
 		}
 
+// ----- IO Read Block / IO Write Block ----------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------------------------------------
+	if ( (THE_Command->Command_Final == IO_Read_Block) || (THE_Command->Command_Final == IO_Write_Block) )
+		{
+		strcpy(temp, "us");
+		io_size = (THE_Command->Size == Byte) ? 1 : (THE_Command->Size == Word) ? 2 : 4;
+		THE_Command->Length = ((THE_Command->Length + io_size - 1) / io_size) * io_size;		// Whole accesses only
+
+		if ( (THE_Command->Display_Time) && (!Resolve_Frequency(THE_Command)) )
+			return;
+
+		if (THE_Command->Command_Final == IO_Read_Block)
+			result9 = io_read_assembly_delay(THE_Command->Address, temp, THE_Command->passed_frequency*1000000000, THE_Command->Length, array11, io_size, THE_Command->Fifo);
+		else
+			{
+			// Need to set array11 up with the write data (little endian, one copy per access)
+			for (q=0; (unsigned long)q < THE_Command->Length; q++)
+				array11[q] = (THE_Command->Data >> ((q % io_size) * 8)) & 0xFF;
+			result9 = io_write_assembly_delay(THE_Command->Address, temp, THE_Command->passed_frequency*1000000000, THE_Command->Length, array11, io_size, THE_Command->Fifo);
+			}
+		Pretty_Output(THE_Command, result9, temp, array11, THE_Command->passed_frequency);
+		}
+
+// ----- IO Watch ---------------------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------------------------------------
+	if (THE_Command->Command_Final == IO_Watch)
+		Watch_Log(THE_Command, copyargv);
+
 // ----- MSR Read ---------------------------------------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------------------------------------------------------
 	if (THE_Command->Command_Final == MSR_Read)
 		{
+		SHF_msr_load_module(THE_Command->nosudox);		// modprobe msr only if it isn't already loaded
 
-		if (THE_Command->nosudox == true)
-			system("modprobe msr");		
+		if ( (strcmp(THE_Command->CPU_List, "") != 0) || (strcmp(THE_Command->Address_List, "") != 0) )
+			MSR_CPUs(THE_Command);								// cpu=... and/or several MSRs
 		else
-			system("sudo modprobe msr");		
-
-		SHF_rdmsr(0, THE_Command->Address, &ret); 
-		printf("============================================================\n");
-		printf("Return Data:  MSR(0x");
-		SHFprint(THE_Command->Address, 2, 0x10,"",") = 0x");
-		SHFprint(ret, 16, 0x10,"","\n");
-		printf("============================================================\n\n");
+			{
+			SHF_rdmsr(0, THE_Command->Address, &ret); 
+			printf("============================================================\n");
+			printf("Return Data:  MSR(0x");
+			SHFprint(THE_Command->Address, 2, 0x10,"",") = 0x");
+			SHFprint(ret, 16, 0x10,"","\n");
+			printf("============================================================\n\n");
+			}
 		}
 
 // ----- MSR Write --------------------------------------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------------------------------------------------------
 	if (THE_Command->Command_Final == MSR_Write)
 		{
-		if (THE_Command->nosudox == true)
-			{
-			cx = snprintf(tempstr, 100, "wrmsr 0x%x 0x%x", (unsigned int)THE_Command->Address, (unsigned int)THE_Command->Data);
-			system("modprobe msr");		
-			}
+		SHF_msr_load_module(THE_Command->nosudox);		// modprobe msr only if it isn't already loaded
+
+		if (strcmp(THE_Command->CPU_List, "") != 0)
+			MSR_CPUs(THE_Command);								// cpu=...
 		else
 			{
-			cx = snprintf(tempstr, 100, "sudo wrmsr 0x%x 0x%x", (unsigned int)THE_Command->Address, (unsigned int)THE_Command->Data);
-			system("sudo modprobe msr");		
-			}
-
-		strcat(tempstr, "\0");
-		cx = cx;
-//		printf("Final String: %s\n",tempstr);
-
-		system(tempstr);		
+		// Used to shell out to "sudo wrmsr".  Straight pwrite to /dev/cpu/0/msr now.
+		ret = THE_Command->Data;
+		SHF_wrmsr(0, THE_Command->Address, &ret);
 
 		// Confirmation Read:
 		printf("============================================================\n");
 		SHF_rdmsr(0, THE_Command->Address, &ret); 
 		printf("Confirmation Read:  MSR(0x");
 		SHFprint(THE_Command->Address, 2, 0x10,"",") = 0x");
-		SHFprint(ret, 2, 0x10,"","\n");
+		SHFprint(ret, 16, 0x10,"","\n");
 		printf("============================================================\n\n");
-
+			}
 		}
 
 // ----- PCI Read Byte ----------------------------------------------------------------------------------------------------------
@@ -1255,6 +1839,7 @@ void Execute_Command(struct command *THE_Command, int copyargc, char copyargv[20
 			SHFprint(THE_Command->Device,   2, 0x10,"", ".");
 			SHFprint(THE_Command->Function, 1, 0x10,"", " Not Found!\n");
 			printf("============================================================\n\n");
+			THE_Command->Failed = true;
 			}
 		else
 			{
@@ -1276,6 +1861,7 @@ void Execute_Command(struct command *THE_Command, int copyargc, char copyargv[20
 			SHFprint(THE_Command->Device,   2, 0x10,"", ".");
 			SHFprint(THE_Command->Function, 1, 0x10,"", " Not Found!\n");
 			printf("============================================================\n\n");
+			THE_Command->Failed = true;
 			}
 		else
 			{
@@ -1299,6 +1885,7 @@ void Execute_Command(struct command *THE_Command, int copyargc, char copyargv[20
 			SHFprint(THE_Command->Device,   2, 0x10,"", ".");
 			SHFprint(THE_Command->Function, 1, 0x10,"", " Not Found!\n");
 			printf("============================================================\n\n");
+			THE_Command->Failed = true;
 			}
 		else
 			{
@@ -1329,6 +1916,7 @@ void Execute_Command(struct command *THE_Command, int copyargc, char copyargv[20
 			SHFprint(THE_Command->Device,   2, 0x10,"", ".");
 			SHFprint(THE_Command->Function, 1, 0x10,"", " Not Found!\n");
 			printf("============================================================\n\n");
+			THE_Command->Failed = true;
 			}
 		else
 			{
@@ -1357,6 +1945,7 @@ void Execute_Command(struct command *THE_Command, int copyargc, char copyargv[20
 			SHFprint(THE_Command->Device,   2, 0x10,"", ".");
 			SHFprint(THE_Command->Function, 1, 0x10,"", " Not Found!\n");
 			printf("============================================================\n\n");
+			THE_Command->Failed = true;
 			}
 		else
 			{
@@ -1387,6 +1976,7 @@ void Execute_Command(struct command *THE_Command, int copyargc, char copyargv[20
 			SHFprint(THE_Command->Device,   2, 0x10,"", ".");
 			SHFprint(THE_Command->Function, 1, 0x10,"", " Not Found!\n");
 			printf("============================================================\n\n");
+			THE_Command->Failed = true;
 			}
 		else
 			{
@@ -1420,11 +2010,11 @@ void Execute_Command(struct command *THE_Command, int copyargc, char copyargv[20
 			SHFprint(THE_Command->Device,   2, 0x10,"", ".");
 			SHFprint(THE_Command->Function, 1, 0x10,"", " Not Found!\n");
 			printf("============================================================\n\n");
+			THE_Command->Failed = true;
 			}
 		else
 			{
-			for (cx=0x00; cx<=(Found_Size-1); cx++)
-			   array11[cx] = SHFpci_read_byte(THE_Command->Bus, THE_Command->Device, THE_Command->Function, (THE_Command->Address+cx));
+			SHFpci_read_block(THE_Command->Bus, THE_Command->Device, THE_Command->Function, THE_Command->Address, array11, Found_Size);
 			THE_Command->Length = Found_Size;
 			THE_Command->Size = 1;
 			THE_Command->Address = 0;
@@ -1436,27 +2026,545 @@ void Execute_Command(struct command *THE_Command, int copyargc, char copyargv[20
 // ------------------------------------------------------------------------------------------------------------------------------
 	if (THE_Command->Command_Final == PCI_Dump_File)
 		{
-		// sudo lspci -xxxx > regdump.txt
-		if (THE_Command->nosudox == true)
-			cx = snprintf(tempstr, 100, "lspci -xxxx >  %s", copyargv[THE_Command->Filename_int]);
+		// Used to be:  sudo lspci -xxxx > regdump.txt
+		// Now we scan every domain/bus/device/function ourselves (worker threads), same output format
+		Found_Size = SHFpci_dump_all(copyargv[THE_Command->Filename_int], THE_Command->Threads, THE_Command->Binary);
+
+		printf("============================================================\n");
+		if ((int)Found_Size < 0)
+			{
+			printf("Could not write PCI Register Dump file %s\n", copyargv[THE_Command->Filename_int]);
+			THE_Command->Failed = true;
+			}
 		else
-			cx = snprintf(tempstr, 100, "sudo lspci -xxxx >  %s", copyargv[THE_Command->Filename_int]);
+			{
+			printf("Full PCI Register Dump saved into file %s\n", copyargv[THE_Command->Filename_int]);
+			SHFprint(Found_Size, 1, 10, "Functions dumped: ", (THE_Command->Binary ? "  (binary)\n" : "  (lspci -n -xxxx format)\n"));
+			}
+		printf("============================================================\n\n");
+		}
+
+	// array11 is the SHF_buffer arena - it stays around for the next command
+
+	}	// End of Execute_Command()
 
-		strcat(tempstr, "\0");
-		cx = cx;
-//		printf("Final String: %s\n",tempstr);
 
-		system(tempstr);		
+//===========================================================
+//===========================================================
+void MSR_CPUs(struct command *THE_Command)
+	{
+	static int cpus[4096];
+	unsigned int msrs[16];
+	unsigned long long *values;
+	unsigned long long ret;
+	int cpu_count, msr_count = 0, failures = 0;
+	int c, m;
+	char *list, *pEnd;
+	char heading[32];
+	struct timespec start_time, end_time;
+
+	if (strcmp(THE_Command->CPU_List, "") == 0)
+		{
+		cpus[0] = 0;
+		cpu_count = 1;
+		}
+	else
+		cpu_count = SHF_parse_cpu_list(THE_Command->CPU_List, cpus, 4096);
 
+	if (cpu_count <= 0)
+		{
 		printf("============================================================\n");
-		printf("Full PCI Register Dump saved into file %s\n", copyargv[THE_Command->Filename_int]);
+		printf("Bad CPU list:  cpu=%s\n", THE_Command->CPU_List);
 		printf("============================================================\n\n");
+		THE_Command->Failed = true;
+		return;
 		}
 
+	// One MSR, or a comma separated list of them
+	list = THE_Command->Address_List;
+	if (strcmp(list, "") == 0)
+		msrs[msr_count++] = THE_Command->Address;
+	while ( (*list) && (msr_count < 16) )
+		{
+		msrs[msr_count] = strtoul(list, &pEnd, 0);
+		if (pEnd == list)
+			break;
+		msr_count++;
+		list = pEnd;
+		if (*list == ',')
+			list++;
+		}
 
-	free(array11);
+	values = calloc(cpu_count * msr_count, sizeof(unsigned long long));
+	if (values == NULL)
+		{
+		THE_Command->Failed = true;
+		return;
+		}
 
-	}	// End of Execute_Command()
+	clock_gettime(CLOCK_MONOTONIC, &start_time);
+	if (THE_Command->Access_Type == Write)
+		{
+		// Writes are one at a time (and only the first MSR)
+		msr_count = 1;
+		for (c=0; c<cpu_count; c++)
+			{
+			ret = THE_Command->Data;
+			if (SHF_wrmsr(cpus[c], msrs[0], &ret) != 0)
+				failures++;
+			}
+		}
+	failures = failures + SHF_rdmsr_cpus(cpus, cpu_count, msrs, msr_count, values);
+	clock_gettime(CLOCK_MONOTONIC, &end_time);
+
+	printf("============================================================\n");
+	if (THE_Command->Access_Type == Write)
+		{
+		SHFprint(THE_Command->Data, 16, 0x10, "Data Write = 0x", "\n");
+		printf("Confirmation Read:\n");
+		}
+	printf("CPU   ");
+	for (m=0; m<msr_count; m++)
+		{
+		snprintf(heading, sizeof(heading), "MSR(0x%X)", msrs[m]);
+		printf("  %-18s   ", heading);
+		}
+	printf("\n");
+	for (c=0; c<cpu_count; c++)
+		{
+		printf("%4d: ", cpus[c]);
+		for (m=0; m<msr_count; m++)
+			SHFprint(values[(c * msr_count) + m], 16, 0x10, "  0x", "   ");
+		printf("\n");
+		}
+	printf("\n%d CPUs x %d MSRs in %.3f ms", cpu_count, msr_count,
+			((end_time.tv_sec - start_time.tv_sec) * 1000.0) + ((end_time.tv_nsec - start_time.tv_nsec) / 1000000.0));
+	if (failures)
+		{
+		printf("   (%d accesses FAILED)", failures);
+		THE_Command->Failed = true;
+		}
+	printf("\n============================================================\n\n");
+
+	free(values);
+	}
+
+
+//===========================================================
+//===========================================================
+// mem ... x/xb ... threads=# / cpu=... / sweep
+// Splits the block transfer across pinned threads (SHF_block_bandwidth) and reports per-thread
+// and aggregate GB/s.  With sweep, runs 1, 2, 4 ... threads to see where the link/controller saturates.
+void Memory_Bandwidth(struct command *THE_Command, u8 array11[])
+	{
+	static int cpus[4096];
+	struct SHF_bandwidth *results;
+	double frequency, aggregate, low, high;
+	u64 bytes;
+	int cpu_count, thread_count, max_threads, used, t;
+
+	if (strcmp(THE_Command->CPU_List, "") == 0)
+		{
+		cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+		if (cpu_count > 4096)
+			cpu_count = 4096;
+		for (t=0; t<cpu_count; t++)
+			cpus[t] = t;
+		}
+	else
+		cpu_count = SHF_parse_cpu_list(THE_Command->CPU_List, cpus, 4096);
+
+	if (cpu_count <= 0)
+		{
+		printf("============================================================\n");
+		printf("Bad CPU list:  cpu=%s\n", THE_Command->CPU_List);
+		printf("============================================================\n\n");
+		THE_Command->Failed = true;
+		return;
+		}
+
+	// threads=# picks how many (from the front of the CPU list), else one per CPU in the list
+	max_threads = cpu_count;
+	if ( (THE_Command->Threads) && ((int)THE_Command->Threads < cpu_count) )
+		max_threads = THE_Command->Threads;
+
+	frequency = THE_Command->passed_frequency * 1000000000;
+	if (frequency == 0)
+		frequency = Freq_Calc();
+	if (frequency <= 0)
+		{
+		printf("Couldn't determine the TSC frequency.  Pass f=#.##\n");
+		THE_Command->Failed = true;
+		return;
+		}
+	bytes = (THE_Command->Block_Bytes) ? THE_Command->Length : THE_Command->Length * 0x1000;
+
+	results = calloc(max_threads, sizeof(struct SHF_bandwidth));
+	if (results == NULL)
+		{
+		THE_Command->Failed = true;
+		return;
+		}
+
+	printf("============================================================\n");
+	printf("Mem Address%s", (THE_Command->Access_Type == Write) ? "(Write): " : "(Read) : ");
+	SHFprint(THE_Command->Address, 8, 0x10, "0x", "");
+	SHFprint(bytes, 8, 0x10, "   Length: 0x", " bytes\n");
+	printf("Frequency:          %2.5fGHz\n", frequency / 1000000000);
+	if (THE_Command->Sweep)
+		printf("\nThreads   Aggregate GB/s   Per Thread GB/s (min - max)\n");
+
+	thread_count = (THE_Command->Sweep) ? 1 : max_threads;
+	while (thread_count <= max_threads)
+		{
+		used = SHF_block_bandwidth(THE_Command->Address, bytes, (THE_Command->Access_Type == Write), array11,
+											cpus, thread_count, frequency, results, &aggregate);
+		if (used < 0)
+			{
+			printf("%d threads:  mapping or thread start FAILED (root?  CPU online?)\n", thread_count);
+			THE_Command->Failed = true;
+			break;
+			}
+
+		if (THE_Command->Sweep)
+			{
+			low = high = results[0].gbps;
+			for (t=1; t<used; t++)
+				{
+				if (results[t].gbps < low)
+					low = results[t].gbps;
+				if (results[t].gbps > high)
+					high = results[t].gbps;
+				}
+			printf("%7d   %14.3f   %.3f - %.3f\n", used, aggregate, low, high);
+			}
+		else
+			{
+			printf("\nThread   CPU        Bytes        GB/s\n");
+			for (t=0; t<used; t++)
+				printf("%6d  %4d  %11llu  %10.3f\n", t, results[t].cpu, (unsigned long long)results[t].bytes, results[t].gbps);
+			printf("\nAggregate:  %.3f GB/s  (%d threads)\n", aggregate, used);
+			}
+
+		if ( (used < thread_count) || (thread_count == max_threads) )
+			break;
+		thread_count = (thread_count * 2 > max_threads) ? max_threads : thread_count * 2;
+		}
+	printf("Kernel:             %s\n", SHF_block_kernel_name(SHF_block_kernel_used()));
+	printf("Pages:              %s\n", SHF_timed_pages_name());
+	printf("============================================================\n\n");
+
+	free(results);
+	}
+
+
+//===========================================================
+//===========================================================
+// mem ... x/xb ... out=file (or out=- for stdout)
+// Streams the range to the file in chunks (SHF_mem_dump).  Messages go to stderr, so
+// "out=-" can be piped.
+void Memory_Dump(struct command *THE_Command, char *filename)
+	{
+	struct timespec start_time, end_time;
+	long long written;
+	double seconds;
+	u64 bytes;
+
+	bytes = (THE_Command->Block_Bytes) ? THE_Command->Length : THE_Command->Length * 0x1000;
+
+	clock_gettime(CLOCK_MONOTONIC, &start_time);
+	written = SHF_mem_dump(THE_Command->Address, bytes, filename, 0);
+	clock_gettime(CLOCK_MONOTONIC, &end_time);
+	seconds = (end_time.tv_sec - start_time.tv_sec) + ((end_time.tv_nsec - start_time.tv_nsec) / 1000000000.0);
+
+	fprintf(stderr, "============================================================\n");
+	if (written < 0)
+		{
+		fprintf(stderr, "Memory dump of 0x%08lX (0x%llX bytes) to %s FAILED\n", THE_Command->Address,
+			(unsigned long long)bytes, (strcmp(filename, "-") == 0) ? "stdout" : filename);
+		THE_Command->Failed = true;
+		}
+	else
+		fprintf(stderr, "0x%llX bytes from 0x%08lX saved into %s in %.3f sec (%.1f MB/sec)\nKernel:             %s\n",
+			(unsigned long long)written, THE_Command->Address, (strcmp(filename, "-") == 0) ? "stdout" : filename, seconds,
+			(seconds > 0) ? (written / seconds / 1000000.0) : 0.0, SHF_block_kernel_name(SHF_block_kernel_used()));
+	fprintf(stderr, "============================================================\n\n");
+	}
+
+
+//===========================================================
+//===========================================================
+// mem address{,address...} {b/w/d} watch {rate=#} {time=#} {out=file} {binary}
+// io  port{,port...} {b/w/d} watch {rate=#} {time=#} {out=file} {binary}
+// Polls the address(es)/port(s) and logs only the changes, TSC stamped (SHF_mem_watch or
+// SHF_io_watch), to stdout or the out= file.  Runs for time= seconds, or until Ctrl-C.
+// Messages go to stderr.
+void Watch_Log(struct command *THE_Command, char copyargv[20][255])
+	{
+	u64 addresses[SHF_WATCH_MAX_CHANNELS];
+	struct SHF_watch_stats stats;
+	char *filename, *list, *pEnd;
+	double frequency;
+	int count = 0, size;
+
+	// One address, or a comma separated list of them
+	list = THE_Command->Address_List;
+	if (strcmp(list, "") == 0)
+		addresses[count++] = THE_Command->Address;
+	while ( (*list) && (count < SHF_WATCH_MAX_CHANNELS) )		// parse_everything turned longer lists away
+		{
+		addresses[count] = strtoull(list, &pEnd, 0);
+		if (pEnd == list)
+			break;
+		count++;
+		list = pEnd;
+		if (*list == ',')
+			list++;
+		}
+
+	size = (THE_Command->Size == Dword) ? 4 : (THE_Command->Size == Word) ? 2 : 1;
+	filename = (THE_Command->Out_int) ? &copyargv[THE_Command->Out_int][4] : "-";
+	frequency = THE_Command->passed_frequency * 1000000000;
+	if (frequency == 0)
+		frequency = Freq_Calc();
+	if (frequency <= 0)
+		{
+		fprintf(stderr, "Couldn't determine the TSC frequency.  Pass f=#.##\n");
+		THE_Command->Failed = true;
+		return;
+		}
+
+	fprintf(stderr, "============================================================\n");
+	if (THE_Command->Command_Type == io)
+		fprintf(stderr, "Watching %d port%s (%d byte in's), ", count, (count == 1) ? "" : "s", size);
+	else
+		fprintf(stderr, "Watching %d address%s (%d byte reads), ", count, (count == 1) ? "" : "es", size);
+	if (THE_Command->Rate > 0)
+		fprintf(stderr, "%.0f polls/sec, ", THE_Command->Rate);
+	else
+		fprintf(stderr, "as fast as it'll go, ");
+	if (THE_Command->Watch_Time > 0)
+		fprintf(stderr, "for %.3f sec (or Ctrl-C)\n", THE_Command->Watch_Time);
+	else
+		fprintf(stderr, "until Ctrl-C\n");
+	fprintf(stderr, "============================================================\n");
+
+	if (THE_Command->Command_Type == io)
+		{
+		if (SHF_io_watch(addresses, count, size, THE_Command->Rate, THE_Command->Watch_Time, filename, THE_Command->Binary,
+							  frequency, &stats) != 0)
+			{
+			fprintf(stderr, "Watch FAILED (root?  Port < 0x10000?  Can %s be written?)\n", (strcmp(filename, "-") == 0) ? "stdout" : filename);
+			THE_Command->Failed = true;
+			}
+		}
+	else if (SHF_mem_watch(addresses, count, size, THE_Command->Rate, THE_Command->Watch_Time, filename, THE_Command->Binary,
+								  frequency, &stats) != 0)
+		{
+		fprintf(stderr, "Watch FAILED (root?  Address mappable?  Can %s be written?)\n", (strcmp(filename, "-") == 0) ? "stdout" : filename);
+		THE_Command->Failed = true;
+		}
+
+	fprintf(stderr, "============================================================\n");
+	fprintf(stderr, "%llu polls in %.3f sec (%.0f polls/sec).  %llu changes logged",
+		(unsigned long long)stats.polls, stats.seconds, (stats.seconds > 0) ? stats.polls / stats.seconds : 0.0,
+		(unsigned long long)(stats.changes - stats.dropped));
+	if (stats.dropped)
+		fprintf(stderr, ", %llu DROPPED (output couldn't keep up)", (unsigned long long)stats.dropped);
+	fprintf(stderr, "\n============================================================\n\n");
+	}
+
+
+//===========================================================
+//===========================================================
+// mem address {=data} {b/w/d} repeat=# {warmup=#}
+// Times the one access repeat times (SHF_mem_latency) and prints the distribution, in cycles
+// and ns, instead of a single (noisy) sample.
+void Memory_Latency_Histogram(struct command *THE_Command)
+	{
+	static struct SHF_histogram hist;			// ~58KB of buckets
+	static double percentiles[] = { 50, 90, 99, 99.9 };
+	double frequency;
+	u64 warmup, overhead, last_read;
+	int size, p;
+
+	size = (THE_Command->Size == Dword) ? 4 : (THE_Command->Size == Word) ? 2 : 1;
+	warmup = (THE_Command->Warmup >= 0) ? (u64)THE_Command->Warmup : 100;
+	frequency = THE_Command->passed_frequency * 1000000000;
+
+	if (SHF_mem_latency(THE_Command->Address, size, (THE_Command->Access_Type == Write), THE_Command->Data,
+							  THE_Command->Repeat, warmup, &hist, &overhead, &last_read) != 0)
+		{
+		printf("============================================================\n");
+		printf("Couldn't map the address (root?)\n");
+		printf("============================================================\n\n");
+		THE_Command->Failed = true;
+		return;
+		}
+
+	printf("============================================================\n");
+	printf("Mem Address%s", (THE_Command->Access_Type == Write) ? "(Write): " : "(Read) : ");
+	SHFprint(THE_Command->Address, 8, 0x10, "0x", "");
+	printf("   %s accesses x %lu (after %llu warmup)\n", (size == 4) ? "Dword" : (size == 2) ? "Word" : "Byte",
+		THE_Command->Repeat, (unsigned long long)warmup);
+	if (THE_Command->Access_Type == Write)
+		SHFprint(THE_Command->Data, size * 2, 0x10, "Data Written:       0x", "\n");
+	else
+		SHFprint(last_read, size * 2, 0x10, "Last Read Data:     0x", "\n");
+	printf("Frequency:          %2.5fGHz\n\n", THE_Command->passed_frequency);
+
+	printf("              cycles            ns\n");
+	printf("min     %12llu  %12.1f\n", (unsigned long long)hist.min, hist.min * 1000000000.0 / frequency);
+	for (p=0; p<(int)(sizeof(percentiles)/sizeof(percentiles[0])); p++)
+		printf("p%-6g %12llu  %12.1f\n", percentiles[p], (unsigned long long)SHF_hist_percentile(&hist, percentiles[p]),
+			SHF_hist_percentile(&hist, percentiles[p]) * 1000000000.0 / frequency);
+	printf("max     %12llu  %12.1f\n", (unsigned long long)hist.max, hist.max * 1000000000.0 / frequency);
+	printf("mean    %12.1f  %12.1f\n", hist.sum / hist.count, hist.sum / hist.count * 1000000000.0 / frequency);
+	printf("\nTimer overhead:     %llu cycles per sample (included above)\n", (unsigned long long)overhead);
+	printf("============================================================\n\n");
+	}
+
+
+//===========================================================
+//===========================================================
+// mem chase {random} {stride=#} {max=#}                  (local buffer)
+// mem address chase max=# {random} {stride=#}            (/dev/mem range - gets overwritten!)
+// Pointer chase (SHF_chase) at working sets of 4K, 6K, 8K, 12K ... max, one line each as it
+// goes.  The steps in ns/load are L1/L2/LLC/DRAM (or the device).
+void Memory_Chase_Sweep(struct command *THE_Command)
+	{
+	volatile u8 *base;
+	unsigned long long max_set, working_set;
+	double frequency, cycles;
+	int half = 0;
+
+	max_set = (THE_Command->Max_Set) ? THE_Command->Max_Set : 0x10000000ULL;		// 256MB local default
+	frequency = THE_Command->passed_frequency * 1000000000;
+
+	if (THE_Command->Address_Valid)
+		base = SHFmem_map(THE_Command->Address, max_set);
+	else
+		base = SHF_buffer(max_set, 1);
+	if (base == NULL)
+		{
+		printf("============================================================\n");
+		printf("Couldn't get 0x%llX bytes to chase through (root?  Enough memory?)\n", max_set);
+		printf("============================================================\n\n");
+		THE_Command->Failed = true;
+		return;
+		}
+
+	printf("============================================================\n");
+	if (THE_Command->Address_Valid)
+		SHFprint(THE_Command->Address, 8, 0x10, "Pointer Chase:      Mem 0x", " (contents overwritten)\n");
+	else
+		printf("Pointer Chase:      Local buffer\n");
+	printf("Pattern:            %s, %lu byte stride\n", (THE_Command->Random) ? "random" : "sequential", THE_Command->Stride);
+	printf("Frequency:          %2.5fGHz\n\n", THE_Command->passed_frequency);
+	printf("   Working Set     cycles/load       ns/load\n");
+
+	// 4K, 6K, 8K, 12K, 16K ... (powers of 2 and halfway between them)
+	working_set = 0x1000;
+	while (working_set <= max_set)
+		{
+		cycles = SHF_chase(base, working_set, THE_Command->Stride, THE_Command->Random, THE_Command->Repeat);
+		if (cycles < 0)
+			printf("%11llu KB     (stride too big for this size, or out of memory)\n", working_set >> 10);
+		else
+			printf("%11llu KB  %14.2f  %12.2f\n", working_set >> 10, cycles, cycles * 1000000000.0 / frequency);
+		fflush(stdout);
+
+		working_set = (half) ? (working_set / 3) * 4 : (working_set / 2) * 3;
+		half = !half;
+		}
+	printf("============================================================\n\n");
+	}
+
+
+//===========================================================
+//===========================================================
+// "4096", "0x1000", "4K", "16M", "2G" -> bytes
+unsigned long long Size_Value(char *string)
+	{
+	unsigned long long value;
+	char *pEnd;
+
+	value = strtoull(string, &pEnd, 0);
+	if (*pEnd == 'K')
+		value = value << 10;
+	else if (*pEnd == 'M')
+		value = value << 20;
+	else if (*pEnd == 'G')
+		value = value << 30;
+	return value;
+	}
+
+
+//===========================================================
+//===========================================================
+// "0x10,0x198,0x199" -> 3.  "" -> 0.
+int List_Count(char *list)
+	{
+	int count;
+
+	if (*list == '\0')
+		return 0;
+	for (count=1; *list; list++)
+		if (*list == ',')
+			count++;
+	return count;
+	}
+
+
+//===========================================================
+//===========================================================
+// No f=#.## passed:  work out the TSC frequency, say how it was found, and keep it in
+// passed_frequency (GHz) so the rest of the command uses it.  false (and Failed) if nothing
+// could work it out - every time/bandwidth figure would be inf/NaN.
+bool Resolve_Frequency(struct command *THE_Command)
+	{
+	double frequency;
+	struct SHF_freq_info freq_info;
+
+	if (THE_Command->passed_frequency != (double)0.0)
+		return true;
+
+	printf("You didn't pass a system frequency via command line parameter 'f=#.##'\n");
+	frequency = Freq_Calc(); // This will be 3.2 for 3.2 GHz
+	if (frequency <= 0)
+		{
+		printf("Couldn't determine the TSC frequency.  Pass f=#.##\n");
+		THE_Command->Failed = true;
+		return false;
+		}
+	SHF_Freq_Info(&freq_info);
+	printf("Calculated Frequency \t= %f GHz (%s, +/- %.1f ppm%s)\n\n", frequency/1000000000, freq_info.source,
+		freq_info.error * 1000000 / frequency, (freq_info.invariant) ? "" : ", TSC is NOT invariant");
+	THE_Command->passed_frequency = frequency/1000000000;
+	return true;
+	}
+
+
+//===========================================================
+//===========================================================
+// How big array11 has to be for this command.  Never less than 64KB - the write data
+// loops fill at least that much.
+unsigned long Buffer_Size(struct command *THE_Command)
+	{
+	unsigned long size;
+
+	if ( ((THE_Command->Command_Type != mem) && (THE_Command->Command_Type != io)) || (THE_Command->Out_int) )
+		size = 0;														// msr/pci:  a 4K PCI dump at most.  out=:  own buffers
+	else if ( (THE_Command->Size == XBlock) && (!THE_Command->Block_Bytes) )
+		size = THE_Command->Length * 0x1000;
+	else
+		size = THE_Command->Length;
+
+	size = (size + 0x10 + 0xF) & ~0xFUL;						// Write patterns go 16 bytes at a time
+	if (size < 0x10000)
+		size = 0x10000;
+	return size;
+	}
 
 
 //===========================================================
@@ -1486,7 +2594,9 @@ void Not_Done_Yet(struct command *THE_Command, int copyargc, char copyargv[20][2
 	printf(" (20)PCI_Read_Byte,      (21)PCI_Read_Word,      (22)PCI_Read_Dword,                          // 20-22\n");     
 	printf(" (23)PCI_Write_Byte,     (24)PCI_Write_Word,     (25)PCI_Write_Dword,                         // 23-25\n");     
 	printf(" (26)PCI_Dump_Device,    (27)PCI_Dump_File,      (28)PCI_Detailed_Help,                       // 26-28\n");     
-	printf(" (29)Generic_Help                                                                             // 29\n");     
+	printf(" (29)Generic_Help,                                                                            // 29\n");     
+	printf(" (30)Memory_Watch,       (31)Memory_Latency,     (32)Memory_Chase                             // 30-32\n");     
+	printf(" (33)IO_Read_Block,      (34)IO_Write_Block,     (35)IO_Watch                                 // 33-35\n");     
 	printf("\n");
 
 	printf("helpx           : %X\n", (unsigned int)THE_Command->helpx);
@@ -1515,11 +2625,13 @@ void Pretty_Output(   struct command *THE_Command, float result9, char *temp, u8
 	{
 	unsigned long Start_Address;	
 	unsigned long End_Address;	
+	unsigned long dump_base;
    unsigned long int j=0;
    unsigned long length;
    bool dots_printed=false;
 	unsigned long int i;
 	unsigned int numb_bytes;
+	u64 fence_lines;
 
 	printf("============================================================\n");
 	if (THE_Command->Command_Type == mem)
@@ -1559,7 +2671,9 @@ void Pretty_Output(   struct command *THE_Command, float result9, char *temp, u8
 		printf("XBLOCK");
 
 
-	if (THE_Command->Size == XBlock)
+	if ( (THE_Command->Size == XBlock) && (THE_Command->Block_Bytes) )
+		SHFprint(THE_Command->Length, 4, 0x10,"  Length: 0x"," bytes\n");
+	else if (THE_Command->Size == XBlock)
 		{
 		SHFprint(THE_Command->Length, 4, 0x10,"  Length: 0x"," (4K blocks)=");
 		SHFprint((THE_Command->Length*0x1000), 4, 0x10,"0x"," bytes\n");
@@ -1569,6 +2683,8 @@ void Pretty_Output(   struct command *THE_Command, float result9, char *temp, u8
 		printf("\n");
 	else if ( THE_Command->Command_Type == pci) 
 		printf("\n");
+	else if (THE_Command->Fifo)
+		SHFprint(THE_Command->Length, 4, 0x10,"  Length: 0x","  (FIFO)\n");
 	else 
 		SHFprint(THE_Command->Length, 4, 0x10,"  Length: 0x","\n");
 
@@ -1582,36 +2698,41 @@ void Pretty_Output(   struct command *THE_Command, float result9, char *temp, u8
 	if (THE_Command->Access_Type == Write)
 		{
 		SHFprint(THE_Command->Data, i, 0x10,"\nData Write = 0x","\n");
-		printf("Data Read Back:\n");
+		if (THE_Command->Command_Final == IO_Write_Block)
+			printf("No follow-On reads for I/O Write Commands (Can cause unexpected behaviors!\n");
+		else
+			printf("Data Read Back:\n");
 		}
 
 	// Now things get interesting
 	if (THE_Command->Size == XBlock)
 		{
+		length = (THE_Command->Block_Bytes) ? THE_Command->Length : THE_Command->Length*0x1000;
 		printf("             0  1  2  3  4  5  6  7  8  9  A  B  C  D  E  F\n");
 		printf("             -----------------------------------------------\n");
 		Start_Address = THE_Command->Address & 0xFFFFFFF0;
-		End_Address = (THE_Command->Address + (THE_Command->Length*0x1000)-1) | 0x0000000F;
-		for (i=Start_Address; i<Start_Address+0x40; i++)
-			{
-			if ( (i & 0x0000000F) == 0)
-				SHFprint(i, 8, 0x10,"0x",":  ");
-			SHFprint(array11[i-THE_Command->Address], 2, 0x10,""," ");
-			if ( (i & 0x0000000F) == 0xF)
-				printf("\n");
-			}
-		printf("...\n");
+		End_Address = (THE_Command->Address + length-1) | 0x0000000F;
 
-		for (i=End_Address-0x40+1; i<=End_Address; i++)
+		// First 0x40 and last 0x40 bytes.  Bytes outside the transfer (unaligned ends) are "xx"
+		// (used to index array11 with a negative offset for unaligned addresses)
+		for (i=Start_Address; i<=End_Address; i++)
 			{
+			if ( ((End_Address - Start_Address) >= 0x80) && (i == Start_Address+0x40) )
+				{
+				printf("...\n");
+				i = End_Address-0x3F;
+				}
 			if ( (i & 0x0000000F) == 0)
 				SHFprint(i, 8, 0x10,"0x",":  ");
-			SHFprint(array11[i-THE_Command->Address], 2, 0x10,""," ");
+			if ( (i < THE_Command->Address) || (i > (THE_Command->Address + length-1) ) )
+				printf("xx ");
+			else
+				SHFprint(array11[i-THE_Command->Address], 2, 0x10,""," ");
 			if ( (i & 0x0000000F) == 0xF)
 				printf("\n");
 			}
 		}
-	else		// Everything NOT block mode!
+	else if (THE_Command->Command_Final != IO_Write_Block)		// Everything NOT block mode!
 		{
 		if (THE_Command->Command_Type == pci)
 			{
@@ -1624,8 +2745,9 @@ void Pretty_Output(   struct command *THE_Command, float result9, char *temp, u8
 			printf("             -----------------------------------------------\n");
 			}
 
-		Start_Address = THE_Command->Address & 0xFFFFFFF0;
-		End_Address = (THE_Command->Address + THE_Command->Length-1) | 0x0000000F;
+		dump_base = (THE_Command->Fifo) ? 0 : THE_Command->Address;		// FIFO data is all from one port:  show offsets
+		Start_Address = dump_base & 0xFFFFFFF0;
+		End_Address = (dump_base + THE_Command->Length-1) | 0x0000000F;
       length = End_Address - Start_Address;
 
 		for (i=Start_Address; i<=End_Address; i++)
@@ -1649,10 +2771,10 @@ void Pretty_Output(   struct command *THE_Command, float result9, char *temp, u8
 				   else
 					   SHFprint(i, 8, 0x10,"0x",":  ");
 				   }
-			   if ( (i < THE_Command->Address) || (i > (THE_Command->Address + THE_Command->Length-1) ) )
+			   if ( (i < dump_base) || (i > (dump_base + THE_Command->Length-1) ) )
 				   printf("xx ");
 			   else
-				   SHFprint(array11[i-THE_Command->Address], 2, 0x10,""," ");
+				   SHFprint(array11[i-dump_base], 2, 0x10,""," ");
 			   if ( (i & 0x0000000F) == 0xF)
 				   printf("\n");
 			   }
@@ -1667,16 +2789,28 @@ void Pretty_Output(   struct command *THE_Command, float result9, char *temp, u8
 		printf(" %s\n", temp);
 
 		// Let's calculate BW
-		if (THE_Command->Size == XBlock)
+		if ( (THE_Command->Size == XBlock) && (!THE_Command->Block_Bytes) )
 			numb_bytes = THE_Command->Length * 0x1000;
 		else
 			numb_bytes = THE_Command->Length;
 		SHFprint(numb_bytes, 6, 0x10,"Bytes Transferred:  0x","");
 		printf("         Bandwidth: %f", (double)(numb_bytes/result9));
 		printf(" MB/sec\n");
+		if (THE_Command->Size == XBlock)
+			printf("Kernel:             %s\n", SHF_block_kernel_name(SHF_block_kernel_used()));
+		if (THE_Command->Command_Type == mem)
+			{
+			fence_lines = SHF_block_fence_lines(THE_Command->Size != XBlock);
+			if (fence_lines == 0)
+				printf("Fence:              end only");
+			else
+				printf("Fence:              every %llu x 64 bytes", (unsigned long long)fence_lines);
+			printf(" (%s)\n", (THE_Command->Access_Type == Write) ? "SFENCE" : "MFENCE");
+			printf("Pages:              %s\n", SHF_timed_pages_name());
+			}
 		}
 
-	if (THE_Command->Command_Type == io)
+	if ( (THE_Command->Command_Type == io) && (THE_Command->Command_Final != IO_Read_Block) && (THE_Command->Command_Final != IO_Write_Block) )
 		{
 		printf("\nIO Return Data: 0x");
 		i=THE_Command->Length-1;
@@ -1713,6 +2847,34 @@ Version 1.4  (02-09-15)
 		Mint 17 (64 bit)
 		Fedora 21 (64-bit)
 		SUSE 13.2 (64-bit)
+Version 1.5  (10-17-2026)
+	- /dev/mem mappings cached for the life of the process.  SHFmem_ routines and the timed b/w/d/x/xb transfers no longer open/mmap/munmap/close per access.
+	- One libpci session per process.  SHFpci_ routines no longer pci_init/pci_cleanup per register.
+	- PCI device dumps read config space in one block (sysfs pread/pci_read_block) instead of byte by byte.
+	- PCI config accesses go straight through the ECAM (MMCONFIG) windows from the ACPI MCFG table when possible.  'noecam' turns this off.
+	  Each MCFG segment is mapped once, whole (not a bus at a time through the 32 entry mapping cache).
+	- 'pci Filename' no longer shells out to lspci.  Native multi-threaded scan of every domain/bus/device/function (lspci -n -xxxx format, or 'binary').
+	- MSR writes are a pwrite to /dev/cpu/0/msr (no more system("sudo wrmsr")).  modprobe msr only runs if the module isn't loaded.
+	- 'cpu=all' / 'cpu=#,#-#' and comma separated MSR lists.  MSRs read in parallel by threads pinned to each CPU.
+	- TSC frequency comes from CPUID 0x15, or a 20ms calibration against CLOCK_MONOTONIC_RAW (checked against MSR 0xCE/CPUID 0x16), instead of a 5 second HPET spin.  Source and error are printed.
+	- The TSC frequency is cached in $XDG_RUNTIME_DIR/samtool_tsc (or /run/samtool_tsc), keyed by boot ID and CPU, so only the first run after a boot calibrates.
+	- HPET found once (ACPI HPET table, else RCBA) and kept mapped.  Read_HPET is one 64 bit load instead of a PCI read and two /dev/mem mmaps.
+	- XBlock transfers use AVX-512, AVX2, SSE or rep movsq loops picked by CPUID (code_block_read.h/code_block_write.h are gone).  'kernel=' forces one.
+	- 'fence=line/#/4k/end' picks how often timed transfers fence (SFENCE for writes, MFENCE for reads).  Was hard-coded.
+	  Without fence= b/w/d still only fence at the end and x/xb every 4K.
+	- 'xb' = XBlock transfer of any length (bytes) at any address.  rep movsb for the unaligned head/tail, vector kernel for the rest.
+	- 'threads=#' / 'cpu=...' / 'sweep' on x/xb:  parallel bandwidth test.  Range split across pinned threads started together on a TSC time.
+	- 'out=file' (or 'out=-') on an x/xb read streams the range to the file in 1MB chunks (writer thread, 4 buffers).
+	- No more 1GB malloc per command.  Buffer is sized from the length (64KB min), mmap'd with hugepages when big, pre-faulted for timed transfers, and reused.
+	- 'watch' on mem b/w/d reads:  polls the address(es) ('rate=' polls/sec, 'time=' seconds, or Ctrl-C) and logs only changes, TSC stamped, through a lock-free ring to stdout or 'out=' ('binary' too).
+	- 'repeat=#' ('warmup=#') on mem b/w/d:  times the access # times into a log-linear histogram and prints min/p50/p90/p99/p99.9/max/mean in cycles and ns.
+	- 'chase' ('random', 'stride=#', 'max=#'):  pointer chase latency vs. working set size (4KB up) on a local buffer, or a /dev/mem range at the address.
+	- Timed transfers prefault the buffer before the clock starts (the /dev/mem mapping has nothing to fault).  'cold' times the faults on purpose, 'lock' mlocks the buffer.  Unaligned b/w/d timed transfers map the right page.
+	- I/O port permission is granted once per process (ioperm ranges cached in a bitmap of all 64K ports, never iopl) instead of ioperm on/off around every in/out.  SHF_IO_release() gives it back.  No permission = an error message, not a SIGSEGV.
+	- io block mode:  a length > the access size reads/writes a port range (port, port+size ...), 'fifo' pushes the whole length through one port with rep insb/insw/insl (outs for writes).  Timed with f.
+	- 'io port{,port...} watch' (rate=, time=, out=, binary):  POST code / EC port change logger.  Port permission is taken once, then the ports are polled with in's into the same TSC stamped ring and drain thread as mem watch.
+	- 'samtool shell':  interactive mode.  Each line runs through the same parser/Execute_Command in one process, so mappings, the PCI session, MSR fds, the buffer and the frequency are set up once.  history, !!, !n, per-command time.  main() split into Init_Command/Execute_Line (> 19 parameters or a parameter > 254 characters is now an error, not a stack overwrite).
+	- 'samtool script {file/-} {stop/continue}':  batch mode.  Every line of the file (or stdin) runs in one process like the shell, output in order through one big stdout buffer, stop or continue on a failed line (parser errors, command failures and samkit FATAL errors, which no longer end the shell/script process), commands/sec summary on stderr.  Exit code 1 if any line failed.
 	
 
 TO DO: